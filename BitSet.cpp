@@ -0,0 +1,122 @@
+#include "BitSet.h"
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+size_t BitSet::popcount(std::uint64_t word) {
+#if defined(_MSC_VER)
+    return static_cast<size_t>(__popcnt64(word));
+#else
+    return static_cast<size_t>(__builtin_popcountll(word));
+#endif
+}
+
+size_t BitSet::lowestBit(std::uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return index;
+#else
+    return static_cast<size_t>(__builtin_ctzll(word));
+#endif
+}
+
+BitSet::BitSet(size_t bits) : words((bits + 63) / 64, 0), bits(bits) {}
+
+void BitSet::resize(size_t bits) {
+    words.resize((bits + 63) / 64, 0);
+    this->bits = bits;
+    // 缩小后最后一个字中超出的位清零，保证count()正确
+    if (bits % 64 != 0) {
+        words.back() &= (std::uint64_t(1) << (bits % 64)) - 1;
+    }
+}
+
+size_t BitSet::size() const {
+    return bits;
+}
+
+bool BitSet::test(size_t i) const {
+    return i < bits && (words[i / 64] >> (i % 64)) & 1;
+}
+
+void BitSet::set(size_t i) {
+    if (i >= bits) {
+        // 容量不够时才按倍数扩大，逐个追加新ID时均摊O(1)
+        size_t needed = i / 64 + 1;
+        if (needed > words.capacity()) {
+            words.reserve(std::max(needed, words.capacity() * 2));
+        }
+        resize(i + 1);
+    }
+    words[i / 64] |= std::uint64_t(1) << (i % 64);
+}
+
+void BitSet::reset(size_t i) {
+    if (i < bits) {
+        words[i / 64] &= ~(std::uint64_t(1) << (i % 64));
+    }
+}
+
+void BitSet::assign(size_t i, bool value) {
+    if (value) {
+        set(i);
+    } else {
+        reset(i);
+    }
+}
+
+void BitSet::clearAll() {
+    std::fill(words.begin(), words.end(), 0);
+}
+
+size_t BitSet::count() const {
+    size_t total = 0;
+    for (std::uint64_t word : words) {
+        total += popcount(word);
+    }
+    return total;
+}
+
+size_t BitSet::wordCount() const {
+    return words.size();
+}
+
+std::uint64_t BitSet::word(size_t w) const {
+    return w < words.size() ? words[w] : 0;
+}
+
+size_t BitSet::nextSet(size_t from) const {
+    if (from >= bits) {
+        return bits;
+    }
+    // 先屏蔽掉起始字中from之前的位，之后逐字跳过全0的字
+    size_t w = from / 64;
+    std::uint64_t word = words[w] & (~std::uint64_t(0) << (from % 64));
+    while (word == 0) {
+        if (++w == words.size()) {
+            return bits;
+        }
+        word = words[w];
+    }
+    return w * 64 + lowestBit(word);
+}
+
+BitSet& BitSet::operator&=(const BitSet& other) {
+    size_t common = std::min(words.size(), other.words.size());
+    for (size_t w = 0; w < common; ++w) {
+        words[w] &= other.words[w];
+    }
+    std::fill(words.begin() + common, words.end(), 0);
+    return *this;
+}
+
+BitSet& BitSet::andNot(const BitSet& other) {
+    size_t common = std::min(words.size(), other.words.size());
+    for (size_t w = 0; w < common; ++w) {
+        words[w] &= ~other.words[w];
+    }
+    return *this;
+}
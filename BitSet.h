@@ -0,0 +1,58 @@
+#ifndef BIT_SET_H
+#define BIT_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 按64位字紧凑存放的位图，下标通常是图书ID。
+// 计数用popcount逐字统计，集合运算逐字进行，不必逐个访问记录对象。
+class BitSet {
+private:
+    std::vector<std::uint64_t> words;
+    size_t bits;
+
+    static size_t popcount(std::uint64_t word);
+    static size_t lowestBit(std::uint64_t word);
+
+public:
+    explicit BitSet(size_t bits = 0);
+
+    // 扩大或缩小位数，新增的位为0
+    void resize(size_t bits);
+    size_t size() const;
+
+    bool test(size_t i) const;
+    // 超出当前位数时自动扩大
+    void set(size_t i);
+    void reset(size_t i);
+    void assign(size_t i, bool value);
+    // 所有位清零，位数不变
+    void clearAll();
+
+    // 为1的位数
+    size_t count() const;
+    // 下标不小于from的第一个为1的位，没有时返回size()
+    size_t nextSet(size_t from) const;
+    // 第w个64位字（下标w*64起），超出范围时为0；用于逐字批量处理
+    size_t wordCount() const;
+    std::uint64_t word(size_t w) const;
+    // 逐字求交；对方较短时，超出部分视为0
+    BitSet& operator&=(const BitSet& other);
+    // 逐字去掉对方为1的位
+    BitSet& andNot(const BitSet& other);
+
+    // 按下标升序访问每个为1的位
+    template <typename F>
+    void forEachSet(F visit) const {
+        for (size_t w = 0; w < words.size(); ++w) {
+            std::uint64_t word = words[w];
+            while (word != 0) {
+                visit(w * 64 + lowestBit(word));
+                word &= word - 1;
+            }
+        }
+    }
+};
+
+#endif // BIT_SET_H
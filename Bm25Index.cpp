@@ -0,0 +1,258 @@
+#include "Bm25Index.h"
+#include "TextFold.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+const double Bm25Index::K1 = 1.2;
+const double Bm25Index::B = 0.75;
+
+namespace {
+
+inline bool isWordByte(unsigned char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// UTF-8首字节对应的字符长度，格式不正确时按1字节处理
+inline size_t charLength(const std::string& text, size_t pos) {
+    unsigned char c = static_cast<unsigned char>(text[pos]);
+    size_t length = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+    return pos + length <= text.size() ? length : 1;
+}
+
+// 连续非ASCII字符（run中为各字符的起始偏移，end为最后一个字符之后）切成二元组
+void flushRun(const std::string& text, std::vector<size_t>& run, size_t end, std::vector<std::string>& terms) {
+    if (run.size() == 1) {
+        terms.push_back(text.substr(run[0], end - run[0]));
+    }
+    for (size_t i = 1; i < run.size(); ++i) {
+        size_t next = i + 1 < run.size() ? run[i + 1] : end;
+        terms.push_back(text.substr(run[i - 1], next - run[i - 1]));
+    }
+    run.clear();
+}
+
+// a排在b之前；用作堆的比较器时，堆顶是当前k个结果中最差的一个
+struct RanksHigher {
+    bool operator()(const std::pair<int, double>& a, const std::pair<int, double>& b) const {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    }
+};
+
+} // namespace
+
+Bm25Index::Bm25Index(const std::vector<double>& fieldWeights)
+    : weights(fieldWeights), totalLengths(fieldWeights.size(), 0.0) {}
+
+size_t Bm25Index::fieldCount() const {
+    return weights.size();
+}
+
+void Bm25Index::tokenize(const std::string& text, std::vector<std::string>& terms) {
+    size_t wordStart = 0;
+    size_t wordLength = 0;
+    std::vector<size_t> run;   // 连续的非ASCII字符的起始偏移
+    size_t pos = 0;
+    while (pos < text.size()) {
+        unsigned char c = static_cast<unsigned char>(text[pos]);
+        if (c < 0x80) {
+            if (!run.empty()) {
+                flushRun(text, run, pos, terms);
+            }
+            if (isWordByte(c)) {
+                if (wordLength == 0) {
+                    wordStart = pos;
+                }
+                ++wordLength;
+            } else if (wordLength > 0) {
+                terms.push_back(text.substr(wordStart, wordLength));
+                wordLength = 0;
+            }
+            ++pos;
+            continue;
+        }
+
+        if (wordLength > 0) {
+            terms.push_back(text.substr(wordStart, wordLength));
+            wordLength = 0;
+        }
+        run.push_back(pos);
+        pos += charLength(text, pos);
+    }
+    if (!run.empty()) {
+        flushRun(text, run, pos, terms);
+    }
+    if (wordLength > 0) {
+        terms.push_back(text.substr(wordStart, wordLength));
+    }
+}
+
+void Bm25Index::add(int ownerId, std::initializer_list<const std::string*> fields) {
+    remove(ownerId);
+
+    const size_t count = fieldCount();
+    Document& document = documents[ownerId];
+    if (lengths.size() < (static_cast<size_t>(ownerId) + 1) * count) {
+        lengths.resize((static_cast<size_t>(ownerId) + 1) * count, 0);
+    }
+    std::uint16_t* length = &lengths[ownerId * count];
+
+    // 收集(词项, 字段)后排序，相同词项相邻，依次累计各字段词频
+    std::vector<std::pair<std::string, size_t>> occurrences;
+    std::vector<std::string> terms;
+    std::string folded;
+    size_t field = 0;
+    for (const std::string* text : fields) {
+        if (field >= count) {
+            break;
+        }
+        terms.clear();
+        foldText(*text, folded);
+        tokenize(folded, terms);
+        length[field] = static_cast<std::uint16_t>(std::min<size_t>(terms.size(), 0xFFFF));
+        totalLengths[field] += length[field];
+        for (std::string& term : terms) {
+            occurrences.emplace_back(std::move(term), field);
+        }
+        ++field;
+    }
+    std::sort(occurrences.begin(), occurrences.end());
+
+    std::vector<std::uint16_t> freq(count);
+    for (size_t i = 0; i < occurrences.size(); ) {
+        const std::string& key = occurrences[i].first;
+        std::fill(freq.begin(), freq.end(), 0);
+        for (; i < occurrences.size() && occurrences[i].first == key; ++i) {
+            std::uint16_t& value = freq[occurrences[i].second];
+            if (value < 0xFFFF) {
+                ++value;
+            }
+        }
+
+        Term& term = *postings.try_emplace(key).first;
+        PostingList& list = term.second;
+        // ID通常递增，插入位置一般就在末尾
+        size_t pos = std::lower_bound(list.ids.begin(), list.ids.end(), ownerId) - list.ids.begin();
+        list.ids.insert(list.ids.begin() + pos, ownerId);
+        list.freqs.insert(list.freqs.begin() + pos * count, freq.begin(), freq.end());
+        document.terms.push_back(&term);
+    }
+}
+
+void Bm25Index::remove(int ownerId) {
+    auto it = documents.find(ownerId);
+    if (it == documents.end()) {
+        return;
+    }
+
+    const size_t count = fieldCount();
+    for (Term* term : it->second.terms) {
+        PostingList& list = term->second;
+        size_t pos = std::lower_bound(list.ids.begin(), list.ids.end(), ownerId) - list.ids.begin();
+        list.ids.erase(list.ids.begin() + pos);
+        list.freqs.erase(list.freqs.begin() + pos * count, list.freqs.begin() + (pos + 1) * count);
+        if (list.ids.empty()) {
+            std::string key = term->first;
+            postings.erase(key);
+        }
+    }
+    for (size_t field = 0; field < count; ++field) {
+        totalLengths[field] -= lengths[ownerId * count + field];
+        lengths[ownerId * count + field] = 0;
+    }
+    documents.erase(it);
+}
+
+void Bm25Index::clear() {
+    postings.clear();
+    documents.clear();
+    lengths.clear();
+    totalLengths.assign(fieldCount(), 0.0);
+}
+
+const std::vector<int>* Bm25Index::findPostings(const std::string& term) const {
+    auto it = postings.find(term);
+    return it == postings.end() ? nullptr : &it->second.ids;
+}
+
+std::vector<std::pair<int, double>> Bm25Index::topK(const std::string& query, size_t k) const {
+    std::vector<std::pair<int, double>> results;
+    std::vector<std::string> terms;
+    tokenize(foldText(query), terms);
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    if (k == 0 || terms.empty() || documents.empty()) {
+        return results;
+    }
+
+    const size_t count = fieldCount();
+    const double n = static_cast<double>(documents.size());
+    std::vector<double> averageLengths(count);
+    for (size_t field = 0; field < count; ++field) {
+        averageLengths[field] = std::max(totalLengths[field] / n, 1.0);
+    }
+
+    struct Cursor {
+        const PostingList* list;
+        size_t pos;
+        double idf;
+    };
+    std::vector<Cursor> cursors;
+    for (const std::string& term : terms) {
+        auto it = postings.find(term);
+        if (it != postings.end()) {
+            double df = static_cast<double>(it->second.ids.size());
+            cursors.push_back({&it->second, 0, std::log(1.0 + (n - df + 0.5) / (df + 0.5))});
+        }
+    }
+
+    std::priority_queue<std::pair<int, double>, std::vector<std::pair<int, double>>, RanksHigher> heap;
+    while (true) {
+        // 各倒排表按ID同步前进，每次处理最小的ID
+        int id = -1;
+        for (const Cursor& cursor : cursors) {
+            if (cursor.pos < cursor.list->ids.size() && (id == -1 || cursor.list->ids[cursor.pos] < id)) {
+                id = cursor.list->ids[cursor.pos];
+            }
+        }
+        if (id == -1) {
+            break;
+        }
+
+        const std::uint16_t* length = &lengths[id * count];
+        double score = 0;
+        for (Cursor& cursor : cursors) {
+            if (cursor.pos >= cursor.list->ids.size() || cursor.list->ids[cursor.pos] != id) {
+                continue;
+            }
+            const std::uint16_t* freq = &cursor.list->freqs[cursor.pos * count];
+            double tf = 0;
+            for (size_t field = 0; field < count; ++field) {
+                if (freq[field] > 0) {
+                    tf += weights[field] * freq[field] / (1 - B + B * length[field] / averageLengths[field]);
+                }
+            }
+            score += cursor.idf * tf * (K1 + 1) / (tf + K1);
+            ++cursor.pos;
+        }
+
+        std::pair<int, double> entry(id, score);
+        if (heap.size() < k) {
+            heap.push(entry);
+        } else if (RanksHigher()(entry, heap.top())) {
+            heap.pop();
+            heap.push(entry);
+        }
+    }
+
+    results.resize(heap.size());
+    for (size_t i = results.size(); i > 0; --i) {
+        results[i - 1] = heap.top();
+        heap.pop();
+    }
+    return results;
+}
+
+size_t Bm25Index::size() const {
+    return documents.size();
+}
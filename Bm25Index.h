@@ -0,0 +1,61 @@
+#ifndef BM25_INDEX_H
+#define BM25_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 相关度排序用的倒排索引（BM25F）。
+// 词项：ASCII字母数字组成的单词，以及连续非ASCII字符（汉字等）中相邻两字组成的二元组
+// （只有一个字时取单字），都在foldText规范化之后切分。
+// 每个词项的倒排表按ID升序，记录该词在各字段中的出现次数；
+// 打分时各字段的词频先按字段长度归一化、乘以字段权重后相加，再代入BM25公式。
+// 查询时各词的倒排表按ID同步归并，边合并边放入大小为k的最小堆，
+// 开销只与k和倒排表长度有关，不需要保存全部匹配结果。
+class Bm25Index {
+private:
+    struct PostingList {
+        std::vector<int> ids;                 // 升序
+        std::vector<std::uint16_t> freqs;     // 每个ID占fieldCount个，依次为各字段词频
+    };
+    typedef std::unordered_map<std::string, PostingList>::value_type Term;
+
+    struct Document {
+        std::vector<Term*> terms;             // 出现过的词项，删除时用
+    };
+
+    std::vector<double> weights;              // 字段权重
+    std::unordered_map<std::string, PostingList> postings;
+    std::unordered_map<int, Document> documents;
+    std::vector<std::uint16_t> lengths;       // 按ID索引，每个ID占fieldCount个，依次为各字段词数
+    std::vector<double> totalLengths;         // 各字段词数之和，用于求平均长度
+
+    size_t fieldCount() const;
+
+public:
+    static const double K1;
+    static const double B;
+
+    explicit Bm25Index(const std::vector<double>& fieldWeights);
+
+    // 把文本切分为词项（text需已经foldText规范化），重复的词项保留
+    static void tokenize(const std::string& text, std::vector<std::string>& terms);
+
+    // 加入一条记录，字段个数须与权重个数相同；ID已存在时先删除旧记录
+    void add(int ownerId, std::initializer_list<const std::string*> fields);
+    void remove(int ownerId);
+    void clear();
+
+    // 词项（已规范化）的倒排表中的ID，升序；没有该词项时返回nullptr
+    const std::vector<int>* findPostings(const std::string& term) const;
+    // 与查询最相关的至多k条记录：(ID, 得分)，按得分降序，得分相同时ID小的在前
+    std::vector<std::pair<int, double>> topK(const std::string& query, size_t k) const;
+
+    size_t size() const;
+};
+
+#endif // BM25_INDEX_H
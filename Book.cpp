@@ -1,70 +1,75 @@
 #include "Book.h"
 
-Book::Book() : id(0), borrowed(false) {}
+Book::Book() : id(0), borrowed(false), title(std::make_shared<Title>()) {}
 
 Book::Book(int id, const std::string& name, const std::string& author, const std::string& publisher)
-    : id(id), name(name), author(author), publisher(publisher), borrowed(false) {}
+    : id(id), borrowed(false), title(std::make_shared<Title>(0, name, author, publisher)) {}
 
 int Book::getId() const {
     return id;
 }
 
-std::string Book::getName() const {
-    return name;
+const std::string& Book::getName() const {
+    return title->getName();
 }
 
-std::string Book::getAuthor() const {
-    return author;
+const std::string& Book::getAuthor() const {
+    return title->getAuthor();
 }
 
-std::string Book::getPublisher() const {
-    return publisher;
+const std::string& Book::getPublisher() const {
+    return title->getPublisher();
 }
 
 bool Book::isBorrowed() const {
     return borrowed;
 }
 
-void Book::setId(int id) {
-    this->id = id;
-}
-
-void Book::setName(const std::string& name) {
-    this->name = name;
-}
-
-void Book::setAuthor(const std::string& author) {
-    this->author = author;
+const std::shared_ptr<Title>& Book::getTitle() const {
+    return title;
 }
 
-void Book::setPublisher(const std::string& publisher) {
-    this->publisher = publisher;
+void Book::setId(int id) {
+    this->id = id;
 }
 
 void Book::setBorrowed(bool status) {
+    if (status != borrowed) {
+        if (status) {
+            title->copyBorrowed();
+        } else {
+            title->copyReturned();
+        }
+    }
     this->borrowed = status;
 }
 
+void Book::setTitle(const std::shared_ptr<Title>& title) {
+    this->title = title;
+}
+
 void Book::display() const {
     std::cout << "图书ID: " << id << std::endl;
-    std::cout << "书名: " << name << std::endl;
-    std::cout << "作者: " << author << std::endl;
-    std::cout << "出版社: " << publisher << std::endl;
+    std::cout << "书名: " << title->getName() << std::endl;
+    std::cout << "作者: " << title->getAuthor() << std::endl;
+    std::cout << "出版社: " << title->getPublisher() << std::endl;
     std::cout << "状态: " << (borrowed ? "已借出" : "可借阅") << std::endl;
 }
 
 std::ostream& operator<<(std::ostream& os, const Book& book) {
-    os << book.id << "\n" << book.name << "\n" << book.author << "\n" 
-       << book.publisher << "\n" << book.borrowed;
+    os << book.id << "\n" << book.getName() << "\n" << book.getAuthor() << "\n" 
+       << book.getPublisher() << "\n" << book.borrowed;
     return os;
 }
 
 std::istream& operator>>(std::istream& is, Book& book) {
     is >> book.id;
     is.ignore();
-    std::getline(is, book.name);
-    std::getline(is, book.author);
-    std::getline(is, book.publisher);
+    std::string name, author, publisher;
+    std::getline(is, name);
+    std::getline(is, author);
+    std::getline(is, publisher);
+    book.title = std::make_shared<Title>(0, name, author, publisher);
     is >> book.borrowed;
     return is;
 } 
\ No newline at end of file
@@ -3,14 +3,15 @@
 
 #include <string>
 #include <iostream>
+#include <memory>
+#include "Title.h"
 
+// 一册实体书（副本）。书名、作者、出版社保存在共享的书目记录中
 class Book {
 private:
     int id;                 // 图书ID
-    std::string name;       // 图书名称
-    std::string author;     // 作者
-    std::string publisher;  // 出版社
     bool borrowed;          // 借阅状态（true为已借出）
+    std::shared_ptr<Title> title;  // 所属书目
 
 public:
     Book();
@@ -18,17 +19,18 @@ public:
     
     // 获取图书信息
     int getId() const;
-    std::string getName() const;
-    std::string getAuthor() const;
-    std::string getPublisher() const;
+    const std::string& getName() const;
+    const std::string& getAuthor() const;
+    const std::string& getPublisher() const;
     bool isBorrowed() const;
+    const std::shared_ptr<Title>& getTitle() const;
     
-    // 设置图书信息
+    // 设置图书信息。书名、作者、出版社属于共享的书目，书目已建好检索、分面和排序索引，
+    // 不提供单独修改的接口
     void setId(int id);
-    void setName(const std::string& name);
-    void setAuthor(const std::string& author);
-    void setPublisher(const std::string& publisher);
+    // 借阅状态变化时同步更新书目的可借册数
     void setBorrowed(bool status);
+    void setTitle(const std::shared_ptr<Title>& title);
     
     // 显示图书信息
     void display() const;
@@ -36,6 +38,7 @@ public:
     // 文件读写辅助函数
     friend std::ostream& operator<<(std::ostream& os, const Book& book);
     friend std::istream& operator>>(std::istream& is, Book& book);
+    friend class RecordParser;
 };
 
 #endif // BOOK_H 
\ No newline at end of file
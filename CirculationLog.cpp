@@ -0,0 +1,257 @@
+#include "CirculationLog.h"
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+
+static_assert(sizeof(HistoryEvent) == 32, "HistoryEvent必须是32字节的定长记录");
+
+CirculationLog::CirculationLog() : recordCount(0), lastTime(0) {}
+
+bool CirculationLog::readRecords(std::uint64_t first, size_t count, std::vector<HistoryEvent>& out) const {
+    out.clear();
+    if (first >= recordCount) {
+        return true;
+    }
+    count = static_cast<size_t>(std::min<std::uint64_t>(count, recordCount - first));
+
+    std::ifstream file(dataPath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    out.resize(count);
+    file.seekg(static_cast<std::streamoff>(first * sizeof(HistoryEvent)));
+    file.read(reinterpret_cast<char*>(out.data()), static_cast<std::streamsize>(count * sizeof(HistoryEvent)));
+    out.resize(static_cast<size_t>(file.gcount()) / sizeof(HistoryEvent));
+    return out.size() == count;
+}
+
+void CirculationLog::link(const HistoryEvent& event, std::uint32_t index) {
+    lastOfBook[event.bookId] = index;
+    lastOfReader[event.readerId] = index;
+}
+
+// 索引文件缺失或与数据文件对不上时，读取每块的第一条记录重建
+void CirculationLog::rebuildIndex() {
+    blockStartTimes.clear();
+    std::vector<HistoryEvent> first;
+    for (std::uint64_t start = 0; start < recordCount; start += BLOCK_RECORDS) {
+        if (!readRecords(start, 1, first) || first.empty()) {
+            break;
+        }
+        blockStartTimes.push_back(first[0].time);
+    }
+
+    std::ofstream file(indexPath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(blockStartTimes.data()),
+               static_cast<std::streamsize>(blockStartTimes.size() * sizeof(std::int64_t)));
+}
+
+void CirculationLog::loadHeads() {
+    lastOfBook.clear();
+    lastOfReader.clear();
+    std::uint64_t replayFrom = 0;
+
+    std::ifstream file(headsPath, std::ios::binary);
+    std::uint64_t count = 0;
+    if (file && file.read(reinterpret_cast<char*>(&count), sizeof(count)) && count <= recordCount) {
+        bool ok = true;
+        for (auto* heads : {&lastOfBook, &lastOfReader}) {
+            std::uint32_t n = 0;
+            ok = ok && file.read(reinterpret_cast<char*>(&n), sizeof(n));
+            for (std::uint32_t i = 0; ok && i < n; ++i) {
+                std::int32_t id;
+                std::uint32_t index;
+                ok = file.read(reinterpret_cast<char*>(&id), sizeof(id)) &&
+                     file.read(reinterpret_cast<char*>(&index), sizeof(index));
+                if (ok) {
+                    (*heads)[id] = index;
+                }
+            }
+        }
+        if (ok) {
+            replayFrom = count;
+        } else {
+            lastOfBook.clear();
+            lastOfReader.clear();
+        }
+    }
+
+    // 重放快照之后追加的记录
+    std::vector<HistoryEvent> block;
+    for (std::uint64_t start = replayFrom; start < recordCount; start += block.size()) {
+        if (!readRecords(start, BLOCK_RECORDS, block) || block.empty()) {
+            break;
+        }
+        for (size_t i = 0; i < block.size(); ++i) {
+            link(block[i], static_cast<std::uint32_t>(start + i));
+        }
+    }
+}
+
+void CirculationLog::open(const std::string& path) {
+    dataPath = path;
+    indexPath = path + ".idx";
+    headsPath = path + ".heads";
+    recordCount = 0;
+    lastTime = 0;
+
+    std::error_code ec;
+    std::uintmax_t bytes = std::filesystem::file_size(dataPath, ec);
+    if (ec) {
+        bytes = 0;
+    } else if (bytes % sizeof(HistoryEvent) != 0) {
+        // 上次写入不完整，截掉残缺的记录
+        bytes -= bytes % sizeof(HistoryEvent);
+        std::filesystem::resize_file(dataPath, bytes, ec);
+    }
+    recordCount = bytes / sizeof(HistoryEvent);
+
+    std::vector<HistoryEvent> last;
+    if (recordCount > 0 && readRecords(recordCount - 1, 1, last) && !last.empty()) {
+        lastTime = last[0].time;
+    }
+
+    blockStartTimes.clear();
+    std::uint64_t expectedBlocks = (recordCount + BLOCK_RECORDS - 1) / BLOCK_RECORDS;
+    std::uintmax_t indexBytes = std::filesystem::file_size(indexPath, ec);
+    if (!ec && indexBytes == expectedBlocks * sizeof(std::int64_t)) {
+        std::ifstream file(indexPath, std::ios::binary);
+        blockStartTimes.resize(static_cast<size_t>(expectedBlocks));
+        file.read(reinterpret_cast<char*>(blockStartTimes.data()), static_cast<std::streamsize>(indexBytes));
+    } else {
+        rebuildIndex();
+    }
+
+    loadHeads();
+}
+
+bool CirculationLog::append(HistoryEventType type, int bookId, int readerId, std::time_t time) {
+    if (recordCount >= NO_EVENT) {
+        return false;
+    }
+
+    HistoryEvent event;
+    // 保证时间单调不减，时间索引才能二分
+    event.time = std::max<std::int64_t>(time, lastTime);
+    event.bookId = bookId;
+    event.readerId = readerId;
+    auto book = lastOfBook.find(bookId);
+    event.prevOfBook = book != lastOfBook.end() ? book->second : NO_EVENT;
+    auto reader = lastOfReader.find(readerId);
+    event.prevOfReader = reader != lastOfReader.end() ? reader->second : NO_EVENT;
+    event.type = type;
+    event.reserved = 0;
+
+    std::ofstream file(dataPath, std::ios::binary | std::ios::app);
+    if (!file || !file.write(reinterpret_cast<const char*>(&event), sizeof(event))) {
+        return false;
+    }
+    file.close();
+
+    if (recordCount % BLOCK_RECORDS == 0) {
+        std::ofstream index(indexPath, std::ios::binary | std::ios::app);
+        index.write(reinterpret_cast<const char*>(&event.time), sizeof(event.time));
+        blockStartTimes.push_back(event.time);
+    }
+
+    link(event, static_cast<std::uint32_t>(recordCount));
+    ++recordCount;
+    lastTime = event.time;
+    return true;
+}
+
+bool CirculationLog::saveHeads() const {
+    std::ofstream file(headsPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&recordCount), sizeof(recordCount));
+    for (const auto* heads : {&lastOfBook, &lastOfReader}) {
+        std::uint32_t n = static_cast<std::uint32_t>(heads->size());
+        file.write(reinterpret_cast<const char*>(&n), sizeof(n));
+        for (const auto& entry : *heads) {
+            std::int32_t id = entry.first;
+            file.write(reinterpret_cast<const char*>(&id), sizeof(id));
+            file.write(reinterpret_cast<const char*>(&entry.second), sizeof(entry.second));
+        }
+    }
+    return static_cast<bool>(file);
+}
+
+std::uint64_t CirculationLog::size() const {
+    return recordCount;
+}
+
+namespace {
+
+// 沿链表回溯，next取出上一条记录的编号
+std::vector<HistoryEvent> walkChain(const std::string& path, std::uint32_t index, size_t limit,
+                                    std::uint32_t HistoryEvent::* next) {
+    std::vector<HistoryEvent> events;
+    std::ifstream file(path, std::ios::binary);
+    while (file && index != CirculationLog::NO_EVENT && (limit == 0 || events.size() < limit)) {
+        HistoryEvent event;
+        file.seekg(static_cast<std::streamoff>(static_cast<std::uint64_t>(index) * sizeof(HistoryEvent)));
+        if (!file.read(reinterpret_cast<char*>(&event), sizeof(event))) {
+            break;
+        }
+        events.push_back(event);
+        index = event.*next;
+    }
+    std::reverse(events.begin(), events.end());
+    return events;
+}
+
+} // namespace
+
+std::vector<HistoryEvent> CirculationLog::bookHistory(int bookId, size_t limit) const {
+    auto it = lastOfBook.find(bookId);
+    if (it == lastOfBook.end()) {
+        return std::vector<HistoryEvent>();
+    }
+    return walkChain(dataPath, it->second, limit, &HistoryEvent::prevOfBook);
+}
+
+std::vector<HistoryEvent> CirculationLog::readerHistory(int readerId, size_t limit) const {
+    auto it = lastOfReader.find(readerId);
+    if (it == lastOfReader.end()) {
+        return std::vector<HistoryEvent>();
+    }
+    return walkChain(dataPath, it->second, limit, &HistoryEvent::prevOfReader);
+}
+
+bool CirculationLog::hasBookHistory(int bookId) const {
+    return lastOfBook.count(bookId) > 0;
+}
+
+bool CirculationLog::hasReaderHistory(int readerId) const {
+    return lastOfReader.count(readerId) > 0;
+}
+
+void CirculationLog::forEachBetween(std::time_t from, std::time_t to,
+                                    const std::function<void(const HistoryEvent&)>& visit) const {
+    if (recordCount == 0 || from > to) {
+        return;
+    }
+
+    // 第一个起始时间不早于from的块的前一块：再往前的块结束时间都早于from
+    auto it = std::lower_bound(blockStartTimes.begin(), blockStartTimes.end(), static_cast<std::int64_t>(from));
+    size_t block = it == blockStartTimes.begin() ? 0 : (it - blockStartTimes.begin()) - 1;
+
+    std::vector<HistoryEvent> events;
+    for (std::uint64_t start = block * BLOCK_RECORDS; start < recordCount; start += BLOCK_RECORDS) {
+        if (!readRecords(start, BLOCK_RECORDS, events)) {
+            return;
+        }
+        for (const HistoryEvent& event : events) {
+            if (event.time < from) {
+                continue;
+            }
+            if (event.time > to) {
+                return;
+            }
+            visit(event);
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef CIRCULATION_LOG_H
+#define CIRCULATION_LOG_H
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+
+// 借还事件类型
+enum HistoryEventType {
+    EVENT_BORROW = 1,
+    EVENT_RETURN = 2
+};
+
+// 定长的历史记录（32字节），按追加顺序编号。
+// 每条记录保存同一本书、同一位读者上一条记录的编号，
+// 查询某本书或某位读者的历史时沿链表回溯，不需要扫描整个文件。
+struct HistoryEvent {
+    std::int64_t time;
+    std::int32_t bookId;
+    std::int32_t readerId;
+    std::uint32_t prevOfBook;    // 同一本书的上一条记录，没有时为NO_EVENT
+    std::uint32_t prevOfReader;  // 同一位读者的上一条记录
+    std::int32_t type;           // HistoryEventType
+    std::int32_t reserved;
+};
+
+// 只追加的借还历史。
+// 数据文件按1024条分块，稀疏时间索引记录每块第一条的时间，
+// 按时间范围查询时二分定位到起始块后顺序读取。
+// 各图书、读者最新一条记录的编号在退出时写入快照文件，
+// 启动时只需重放快照之后追加的记录。
+class CirculationLog {
+private:
+    static const size_t BLOCK_RECORDS = 1024;
+
+    std::string dataPath;
+    std::string indexPath;       // 稀疏时间索引
+    std::string headsPath;       // 链表头快照
+    std::uint64_t recordCount;
+    std::int64_t lastTime;
+    std::vector<std::int64_t> blockStartTimes;
+    std::unordered_map<int, std::uint32_t> lastOfBook;
+    std::unordered_map<int, std::uint32_t> lastOfReader;
+
+    bool readRecords(std::uint64_t first, size_t count, std::vector<HistoryEvent>& out) const;
+    void link(const HistoryEvent& event, std::uint32_t index);
+    void rebuildIndex();
+    void loadHeads();
+
+public:
+    static const std::uint32_t NO_EVENT = 0xFFFFFFFFu;
+
+    CirculationLog();
+
+    // 打开（或创建）历史文件，索引和快照文件名在其后加.idx/.heads
+    void open(const std::string& path);
+    bool append(HistoryEventType type, int bookId, int readerId, std::time_t time);
+    // 保存链表头快照，下次启动时不必重放整个文件
+    bool saveHeads() const;
+
+    std::uint64_t size() const;
+    // 某本书/某位读者的全部历史，按时间升序；limit不为0时只取最近的limit条
+    std::vector<HistoryEvent> bookHistory(int bookId, size_t limit = 0) const;
+    std::vector<HistoryEvent> readerHistory(int readerId, size_t limit = 0) const;
+    // 是否有过借还记录（有记录的ID不能再分配给新的图书或读者）
+    bool hasBookHistory(int bookId) const;
+    bool hasReaderHistory(int readerId) const;
+    // 按时间升序访问[from, to]之间的所有记录
+    void forEachBetween(std::time_t from, std::time_t to,
+                        const std::function<void(const HistoryEvent&)>& visit) const;
+};
+
+#endif // CIRCULATION_LOG_H
@@ -0,0 +1,70 @@
+#include "CoBorrowIndex.h"
+#include <algorithm>
+
+CoBorrowIndex::CoBorrowIndex(size_t neighborLimit, size_t recentLimit)
+    : neighborLimit(neighborLimit), recentLimit(recentLimit) {}
+
+// 计数只增不减：不在列表中的书目次数不会超过列表中的最小值，
+// 所以只需与列表末尾比较
+void CoBorrowIndex::updateNeighbors(int titleId, int otherId, std::uint32_t count) {
+    std::vector<std::pair<int, std::uint32_t>>& list = neighbors[titleId];
+
+    size_t i = 0;
+    while (i < list.size() && list[i].first != otherId) {
+        ++i;
+    }
+    if (i < list.size()) {
+        list[i].second = count;
+    } else if (list.size() < neighborLimit) {
+        list.emplace_back(otherId, count);
+        i = list.size() - 1;
+    } else if (!list.empty() && count > list.back().second) {
+        list.back() = std::make_pair(otherId, count);
+        i = list.size() - 1;
+    } else {
+        return;
+    }
+
+    while (i > 0 && list[i - 1].second < list[i].second) {
+        std::swap(list[i - 1], list[i]);
+        --i;
+    }
+}
+
+void CoBorrowIndex::recordBorrow(int readerId, int titleId) {
+    std::deque<int>& history = recent[readerId];
+    for (int otherId : history) {
+        if (otherId == titleId) {
+            continue;
+        }
+        std::uint32_t forward = ++counts[titleId][otherId];
+        std::uint32_t backward = ++counts[otherId][titleId];
+        updateNeighbors(titleId, otherId, forward);
+        updateNeighbors(otherId, titleId, backward);
+    }
+    rememberBorrow(readerId, titleId);
+}
+
+void CoBorrowIndex::rememberBorrow(int readerId, int titleId) {
+    std::deque<int>& history = recent[readerId];
+    auto it = std::find(history.begin(), history.end(), titleId);
+    if (it != history.end()) {
+        history.erase(it);
+    }
+    history.push_back(titleId);
+    if (history.size() > recentLimit) {
+        history.pop_front();
+    }
+}
+
+const std::vector<std::pair<int, std::uint32_t>>& CoBorrowIndex::recommend(int titleId) const {
+    static const std::vector<std::pair<int, std::uint32_t>> none;
+    auto it = neighbors.find(titleId);
+    return it != neighbors.end() ? it->second : none;
+}
+
+void CoBorrowIndex::clear() {
+    counts.clear();
+    neighbors.clear();
+    recent.clear();
+}
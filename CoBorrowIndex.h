@@ -0,0 +1,36 @@
+#ifndef CO_BORROW_INDEX_H
+#define CO_BORROW_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+
+// “借阅此书的读者也借阅了”：书目之间的稀疏共现矩阵。
+// 每次借书只与该读者最近借过的若干书目两两计数，
+// 并为每个书目维护共现次数最多的前N个邻居，查询时直接返回，代价O(N)。
+class CoBorrowIndex {
+private:
+    size_t neighborLimit;        // 每个书目保留的邻居数N
+    size_t recentLimit;          // 每位读者参与计数的最近书目数
+    std::unordered_map<int, std::unordered_map<int, std::uint32_t>> counts;   // 书目 -> (书目 -> 共现次数)
+    std::unordered_map<int, std::vector<std::pair<int, std::uint32_t>>> neighbors;  // 按次数降序
+    std::unordered_map<int, std::deque<int>> recent;   // 读者 -> 最近借过的书目（新的在后）
+
+    void updateNeighbors(int titleId, int otherId, std::uint32_t count);
+
+public:
+    CoBorrowIndex(size_t neighborLimit = 5, size_t recentLimit = 20);
+
+    // 读者借阅了某个书目
+    void recordBorrow(int readerId, int titleId);
+    // 只记录读者借过的书目，不计数（用于补齐没有历史记录的在借图书）
+    void rememberBorrow(int readerId, int titleId);
+    // 与该书目共现次数最多的书目，按次数降序
+    const std::vector<std::pair<int, std::uint32_t>>& recommend(int titleId) const;
+    void clear();
+};
+
+#endif // CO_BORROW_INDEX_H
@@ -0,0 +1,151 @@
+#ifndef DENSE_TABLE_H
+#define DENSE_TABLE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "BitSet.h"
+
+// 以ID为下标直接寻址的记录表。
+// ID由分配器紧凑地分配，所以表的空洞很少：查找只需一次边界检查和一次访问，不必哈希。
+// 删除的位置只清除存活位（墓碑），遍历时跳过，遍历顺序即ID顺序。
+// T需要提供getId()。
+template <typename T>
+class DenseTable {
+private:
+    std::vector<T> slots;        // 下标即ID，0号不用
+    BitSet live;                 // 存活位
+    size_t count;
+
+    template <typename Table, typename Value>
+    class Iterator {
+    private:
+        Table* table;
+        size_t index;
+
+        void skipDead() {
+            while (index < table->slots.size() && !table->live.test(index)) {
+                ++index;
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        Iterator(Table* table, size_t index) : table(table), index(index) { skipDead(); }
+
+        reference operator*() const { return table->slots[index]; }
+        pointer operator->() const { return &table->slots[index]; }
+        Iterator& operator++() { ++index; skipDead(); return *this; }
+        Iterator operator++(int) { Iterator old = *this; ++*this; return old; }
+        bool operator==(const Iterator& other) const { return index == other.index; }
+        bool operator!=(const Iterator& other) const { return index != other.index; }
+    };
+
+public:
+    // 可接受的最大ID，防止损坏的数据让表无限增长：表按最大ID分配，
+    // 读者记录约100字节，一百万个位置约100MB
+    static const int MAX_ID = 1 << 20;
+
+    using iterator = Iterator<DenseTable, T>;
+    using const_iterator = Iterator<const DenseTable, const T>;
+
+    DenseTable() : count(0) {}
+
+    static bool validId(int id) {
+        return id > 0 && id <= MAX_ID;
+    }
+
+    bool contains(int id) const {
+        return id > 0 && live.test(id);
+    }
+
+    T* find(int id) {
+        return contains(id) ? &slots[id] : nullptr;
+    }
+
+    const T* find(int id) const {
+        return contains(id) ? &slots[id] : nullptr;
+    }
+
+    // ID无效或已存在时返回nullptr
+    T* insert(T value) {
+        int id = value.getId();
+        if (!validId(id) || contains(id)) {
+            return nullptr;
+        }
+        if (static_cast<size_t>(id) >= slots.size()) {
+            // 容量不够时才按倍数扩容，逐个追加新ID时均摊O(1)
+            if (static_cast<size_t>(id) >= slots.capacity()) {
+                slots.reserve(std::max(static_cast<size_t>(id) + 1, slots.capacity() * 2));
+            }
+            slots.resize(id + 1);
+            live.resize(id + 1);
+        }
+        slots[id] = std::move(value);
+        live.set(id);
+        ++count;
+        return &slots[id];
+    }
+
+    bool erase(int id) {
+        if (!contains(id)) {
+            return false;
+        }
+        slots[id] = T();     // 释放记录占用的内存，只留下墓碑
+        live.reset(id);
+        --count;
+        return true;
+    }
+
+    // 用一批记录重建整张表，只分配一次；返回因ID无效或重复而跳过的记录数
+    size_t assign(std::vector<T>&& records) {
+        int maxId = 0;
+        for (const T& record : records) {
+            if (validId(record.getId()) && record.getId() > maxId) {
+                maxId = record.getId();
+            }
+        }
+
+        clear();
+        slots.resize(maxId + 1);
+        live.resize(maxId + 1);
+        size_t skipped = 0;
+        for (T& record : records) {
+            int id = record.getId();
+            if (!validId(id) || live.test(id)) {
+                ++skipped;
+                continue;
+            }
+            slots[id] = std::move(record);
+            live.set(id);
+            ++count;
+        }
+        records.clear();
+        return skipped;
+    }
+
+    size_t size() const { return count; }
+    // 存活位图，可与其他按ID索引的位图逐字运算
+    const BitSet& getLive() const { return live; }
+    bool empty() const { return count == 0; }
+
+    void clear() {
+        slots.clear();
+        live.resize(0);
+        count = 0;
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, slots.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, slots.size()); }
+};
+
+#endif // DENSE_TABLE_H
@@ -0,0 +1,101 @@
+#include "FacetIndex.h"
+#include <algorithm>
+
+void FacetIndex::assign(int ownerId, const std::string& value) {
+    auto inserted = valueIds.try_emplace(value, static_cast<int>(values.size()));
+    if (inserted.second) {
+        values.push_back(value);
+        totals.push_back(0);
+        availables.push_back(0);
+    }
+    if (valueOf.size() <= static_cast<size_t>(ownerId)) {
+        valueOf.resize(ownerId + 1, -1);
+    }
+    valueOf[ownerId] = inserted.first->second;
+}
+
+void FacetIndex::addCopy(int ownerId, bool borrowed) {
+    int value = valueOf[ownerId];
+    ++totals[value];
+    if (!borrowed) {
+        ++availables[value];
+    }
+}
+
+void FacetIndex::removeCopy(int ownerId, bool borrowed) {
+    int value = valueOf[ownerId];
+    --totals[value];
+    if (!borrowed) {
+        --availables[value];
+    }
+}
+
+void FacetIndex::setBorrowed(int ownerId, bool borrowed) {
+    availables[valueOf[ownerId]] += borrowed ? -1 : 1;
+}
+
+void FacetIndex::clear() {
+    values.clear();
+    valueIds.clear();
+    valueOf.clear();
+    totals.clear();
+    availables.clear();
+    scratch.clear();
+}
+
+std::vector<FacetIndex::Count> FacetIndex::count(const std::vector<int>& owners, size_t k) const {
+    scratch.resize(values.size(), 0);
+    std::vector<Count> counts;
+    for (int owner : owners) {
+        int value = valueOf[owner];
+        if (scratch[value]++ == 0) {
+            counts.push_back({value, 0});
+        }
+    }
+    for (Count& entry : counts) {
+        entry.matched = scratch[entry.value];
+        scratch[entry.value] = 0;
+    }
+
+    auto more = [](const Count& a, const Count& b) {
+        return a.matched != b.matched ? a.matched > b.matched : a.value < b.value;
+    };
+    if (counts.size() > k) {
+        std::partial_sort(counts.begin(), counts.begin() + k, counts.end(), more);
+        counts.resize(k);
+    } else {
+        std::sort(counts.begin(), counts.end(), more);
+    }
+    return counts;
+}
+
+std::vector<int> FacetIndex::top(size_t k) const {
+    std::vector<int> result;
+    for (size_t value = 0; value < values.size(); ++value) {
+        if (totals[value] > 0) {
+            result.push_back(static_cast<int>(value));
+        }
+    }
+    auto more = [this](int a, int b) {
+        return totals[a] != totals[b] ? totals[a] > totals[b] : a < b;
+    };
+    if (result.size() > k) {
+        std::partial_sort(result.begin(), result.begin() + k, result.end(), more);
+        result.resize(k);
+    } else {
+        std::sort(result.begin(), result.end(), more);
+    }
+    return result;
+}
+
+const std::string& FacetIndex::getValue(int value) const {
+    return values[value];
+}
+
+int FacetIndex::getTotal(int value) const {
+    return totals[value];
+}
+
+int FacetIndex::getAvailable(int value) const {
+    return availables[value];
+}
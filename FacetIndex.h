@@ -0,0 +1,48 @@
+#ifndef FACET_INDEX_H
+#define FACET_INDEX_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 分面计数（如按作者、按出版社）。字段值驻留为从0开始的整数ID，按书目ID记下书目所属的值，
+// 随图书增删、借还增量维护每个值的馆藏册数和可借册数。
+// 统计一组结果的分面时按书目ID查表、在按值ID索引的数组中累加，开销与结果数成正比，
+// 不需要散列或比较字符串
+class FacetIndex {
+public:
+    struct Count {
+        int value;          // 值ID
+        size_t matched;     // 结果中属于该值的册数
+    };
+
+private:
+    std::vector<std::string> values;                 // 值ID -> 值
+    std::unordered_map<std::string, int> valueIds;   // 值 -> 值ID
+    std::vector<int> valueOf;                        // 书目ID -> 值ID，-1表示没有
+    std::vector<int> totals;                         // 按值ID，馆藏册数
+    std::vector<int> availables;                     // 按值ID，可借册数
+    mutable std::vector<size_t> scratch;             // 统计结果时按值ID累加，用完清零
+
+public:
+    // 新建书目时登记它的值
+    void assign(int ownerId, const std::string& value);
+    void addCopy(int ownerId, bool borrowed);
+    void removeCopy(int ownerId, bool borrowed);
+    // 一册的借阅状态改变
+    void setBorrowed(int ownerId, bool borrowed);
+    void clear();
+
+    // owners为每条结果所属的书目ID（一册一个，可以重复），返回结果中册数最多的k个值，
+    // 册数相同时值ID小的在前
+    std::vector<Count> count(const std::vector<int>& owners, size_t k) const;
+    // 馆藏册数最多的k个值的ID
+    std::vector<int> top(size_t k) const;
+
+    const std::string& getValue(int value) const;
+    int getTotal(int value) const;
+    int getAvailable(int value) const;
+};
+
+#endif // FACET_INDEX_H
@@ -0,0 +1,253 @@
+#include "FuzzyIndex.h"
+#include "TextFold.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 解码p处的一个UTF-8字符；格式不正确的字节单独作为一个字符
+std::uint32_t decodeUtf8(const unsigned char*& p, const unsigned char* end) {
+    unsigned char c = *p++;
+    int extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+    if (extra == 0 || end - p < extra) {
+        return c;
+    }
+    std::uint32_t codePoint = c & (0x3F >> extra);
+    for (int i = 0; i < extra; ++i) {
+        if ((p[i] & 0xC0) != 0x80) {
+            return c;
+        }
+        codePoint = (codePoint << 6) | (p[i] & 0x3Fu);
+    }
+    p += extra;
+    return codePoint;
+}
+
+std::vector<std::uint32_t> decodeAll(const std::string& text) {
+    std::vector<std::uint32_t> codePoints;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+    const unsigned char* end = p + text.size();
+    while (p < end) {
+        codePoints.push_back(decodeUtf8(p, end));
+    }
+    return codePoints;
+}
+
+const char FIELD_SEPARATOR = '\x1f';
+
+inline std::uint64_t bigramKey(std::uint32_t first, std::uint32_t second) {
+    return (static_cast<std::uint64_t>(first) << 32) | second;
+}
+
+} // namespace
+
+bool BitParallelMatcher::compile(const std::string& pattern) {
+    std::vector<std::uint32_t> codePoints = decodeAll(pattern);
+    if (codePoints.size() > static_cast<size_t>(MAX_LENGTH)) {
+        return false;
+    }
+
+    std::memset(asciiMasks, 0, sizeof(asciiMasks));
+    otherMasks.clear();
+    length = static_cast<int>(codePoints.size());
+    for (int i = 0; i < length; ++i) {
+        std::uint64_t bit = std::uint64_t(1) << i;
+        if (codePoints[i] < 128) {
+            asciiMasks[codePoints[i]] |= bit;
+            continue;
+        }
+        auto it = std::lower_bound(otherMasks.begin(), otherMasks.end(),
+                                   std::make_pair(codePoints[i], std::uint64_t(0)));
+        if (it != otherMasks.end() && it->first == codePoints[i]) {
+            it->second |= bit;
+        } else {
+            otherMasks.insert(it, std::make_pair(codePoints[i], bit));
+        }
+    }
+    return true;
+}
+
+int BitParallelMatcher::getLength() const {
+    return length;
+}
+
+std::uint64_t BitParallelMatcher::maskOf(std::uint32_t codePoint) const {
+    if (codePoint < 128) {
+        return asciiMasks[codePoint];
+    }
+    auto it = std::lower_bound(otherMasks.begin(), otherMasks.end(),
+                               std::make_pair(codePoint, std::uint64_t(0)));
+    return it != otherMasks.end() && it->first == codePoint ? it->second : 0;
+}
+
+int BitParallelMatcher::distance(const std::string& text) const {
+    return distance(text.data(), text.size());
+}
+
+// Pv/Mv记录动态规划表当前列相邻行之差为+1/-1的位置，score是最后一行的值。
+// 子串匹配时第0行恒为0，所以水平差值左移后不补1
+int BitParallelMatcher::distance(const char* data, size_t size) const {
+    if (length == 0) {
+        return 0;
+    }
+
+    const std::uint64_t high = std::uint64_t(1) << (length - 1);
+    std::uint64_t pv = ~std::uint64_t(0);
+    std::uint64_t mv = 0;
+    int score = length;
+    int best = length;
+
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    while (p < end) {
+        std::uint64_t eq = maskOf(decodeUtf8(p, end));
+        std::uint64_t xv = eq | mv;
+        std::uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        std::uint64_t ph = mv | ~(xh | pv);
+        std::uint64_t mh = pv & xh;
+        if (ph & high) {
+            ++score;
+        } else if (mh & high) {
+            --score;
+        }
+        ph <<= 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+        best = std::min(best, score);
+    }
+    return best;
+}
+
+FuzzyIndex::FuzzyIndex() : maxOwner(0) {}
+
+// 各字段内相邻字符组成的二元组，去重后升序
+std::vector<std::uint64_t> FuzzyIndex::bigrams(const std::string& record) {
+    std::vector<std::uint64_t> keys;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(record.data());
+    const unsigned char* end = p + record.size();
+    bool hasPrevious = false;
+    std::uint32_t previous = 0;
+    while (p < end) {
+        std::uint32_t codePoint = decodeUtf8(p, end);
+        if (codePoint == static_cast<std::uint32_t>(FIELD_SEPARATOR)) {
+            hasPrevious = false;
+            continue;
+        }
+        if (hasPrevious) {
+            keys.push_back(bigramKey(previous, codePoint));
+        }
+        previous = codePoint;
+        hasPrevious = true;
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+void FuzzyIndex::add(int ownerId, std::initializer_list<const std::string*> texts) {
+    remove(ownerId);
+
+    std::string& record = records[ownerId];
+    bool first = true;
+    for (const std::string* text : texts) {
+        if (!first) {
+            record += FIELD_SEPARATOR;
+        }
+        record += foldText(*text);
+        first = false;
+    }
+    for (std::uint64_t key : bigrams(record)) {
+        // ID通常递增，插入位置一般就在末尾
+        std::vector<int>& list = postings[key];
+        list.insert(std::lower_bound(list.begin(), list.end(), ownerId), ownerId);
+    }
+    maxOwner = std::max(maxOwner, ownerId);
+}
+
+void FuzzyIndex::remove(int ownerId) {
+    auto it = records.find(ownerId);
+    if (it == records.end()) {
+        return;
+    }
+
+    for (std::uint64_t key : bigrams(it->second)) {
+        auto list = postings.find(key);
+        auto pos = std::lower_bound(list->second.begin(), list->second.end(), ownerId);
+        list->second.erase(pos);
+        if (list->second.empty()) {
+            postings.erase(list);
+        }
+    }
+    records.erase(it);
+}
+
+void FuzzyIndex::clear() {
+    records.clear();
+    postings.clear();
+    maxOwner = 0;
+}
+
+bool FuzzyIndex::search(const std::string& keyword, int maxErrors,
+                        std::vector<std::pair<int, int>>& results) const {
+    results.clear();
+    std::string pattern = foldText(keyword);
+    BitParallelMatcher matcher;
+    if (pattern.empty() || !matcher.compile(pattern)) {
+        return false;
+    }
+    // 错误数不小于关键字长度时任何记录都能匹配，没有意义
+    maxErrors = std::max(0, std::min(maxErrors, matcher.getLength() - 1));
+
+    auto verify = [&](int ownerId, const std::string& record) {
+        // 逐字段匹配，不让一处匹配跨过字段分隔符
+        int best = maxErrors + 1;
+        size_t begin = 0;
+        while (begin <= record.size()) {
+            size_t end = record.find(FIELD_SEPARATOR, begin);
+            if (end == std::string::npos) {
+                end = record.size();
+            }
+            best = std::min(best, matcher.distance(record.data() + begin, end - begin));
+            begin = end + 1;
+        }
+        if (best <= maxErrors) {
+            results.emplace_back(ownerId, best);
+        }
+    };
+
+    std::vector<std::uint64_t> keys = bigrams(pattern);
+    int threshold = static_cast<int>(keys.size()) - 2 * maxErrors;
+    if (threshold <= 0) {
+        for (const auto& entry : records) {
+            verify(entry.first, entry.second);
+        }
+    } else {
+        // 按ID计数每条记录包含的关键字二元组个数
+        std::vector<std::uint8_t> hits(static_cast<size_t>(maxOwner) + 1, 0);
+        std::vector<int> candidates;
+        for (std::uint64_t key : keys) {
+            auto list = postings.find(key);
+            if (list == postings.end()) {
+                continue;
+            }
+            for (int ownerId : list->second) {
+                if (++hits[ownerId] == threshold) {
+                    candidates.push_back(ownerId);
+                }
+            }
+        }
+        for (int ownerId : candidates) {
+            verify(ownerId, records.at(ownerId));
+        }
+    }
+
+    std::sort(results.begin(), results.end(), [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+        return a.second != b.second ? a.second < b.second : a.first < b.first;
+    });
+    return true;
+}
+
+size_t FuzzyIndex::size() const {
+    return records.size();
+}
@@ -0,0 +1,63 @@
+#ifndef FUZZY_INDEX_H
+#define FUZZY_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 位并行近似匹配（Myers算法）：模式串最多64个字符，每个字符占一位，
+// 扫描文本时每个字符只做十几次位运算，求模式串与文本任一子串的最小编辑距离。
+// 按Unicode字符（而不是UTF-8字节）计算，一个错字算一处错误。
+class BitParallelMatcher {
+private:
+    std::uint64_t asciiMasks[128];                            // ASCII字符在模式串中出现的位置
+    std::vector<std::pair<std::uint32_t, std::uint64_t>> otherMasks;   // 其他字符，按码点升序
+    int length;
+
+    std::uint64_t maskOf(std::uint32_t codePoint) const;
+
+public:
+    static const int MAX_LENGTH = 64;
+
+    // 模式串需已经foldText规范化；超过MAX_LENGTH个字符时返回false
+    bool compile(const std::string& pattern);
+    int getLength() const;
+
+    // 模式串与text中任一子串的最小编辑距离
+    int distance(const char* data, size_t size) const;
+    int distance(const std::string& text) const;
+};
+
+// 模糊检索索引：保存每条记录规范化后的字段（以'\x1f'分隔），并按字符二元组建立倒排表。
+// 检索时先按q-gram引理过滤：每处错误最多破坏两个二元组，
+// 与关键字有至多k处差异的记录至少包含关键字中（去重后）n-2k个二元组，
+// 只对满足的候选记录逐字段运行位并行匹配。n-2k不大于0时无法过滤，逐条匹配。
+class FuzzyIndex {
+private:
+    std::unordered_map<int, std::string> records;                      // ID -> 规范化后的字段
+    std::unordered_map<std::uint64_t, std::vector<int>> postings;      // 二元组 -> 升序的ID
+    int maxOwner;
+
+    static std::vector<std::uint64_t> bigrams(const std::string& record);
+
+public:
+    FuzzyIndex();
+
+    // 加入一条记录；ID已存在时先删除旧记录
+    void add(int ownerId, std::initializer_list<const std::string*> texts);
+    void remove(int ownerId);
+    void clear();
+
+    // 至多maxErrors处差异即可匹配的记录：(ID, 编辑距离)，按距离、ID升序。
+    // 关键字为空或超过BitParallelMatcher::MAX_LENGTH个字符时返回false
+    bool search(const std::string& keyword, int maxErrors,
+                std::vector<std::pair<int, int>>& results) const;
+
+    size_t size() const;
+};
+
+#endif // FUZZY_INDEX_H
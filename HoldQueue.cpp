@@ -0,0 +1,361 @@
+#include "HoldQueue.h"
+#include <fstream>
+#include <cstdio>
+
+HoldQueue::HoldQueue() : tree(1, 0), head(0) {}
+
+int HoldQueue::prefixSum(size_t count) const {
+    int sum = 0;
+    for (size_t i = count; i > 0; i -= i & (~i + 1)) {
+        sum += tree[i];
+    }
+    return sum;
+}
+
+void HoldQueue::update(size_t index, int delta) {
+    for (size_t i = index + 1; i < tree.size(); i += i & (~i + 1)) {
+        tree[i] += delta;
+    }
+}
+
+// 队首之前的位置过多时整体前移，保证空间与队列长度成正比
+void HoldQueue::compact() {
+    if (head < 32 || head * 2 < entries.size()) {
+        return;
+    }
+
+    std::vector<int> live;
+    for (size_t i = head; i < entries.size(); ++i) {
+        if (entries[i] != 0) {
+            live.push_back(entries[i]);
+        }
+    }
+
+    entries = live;
+    head = 0;
+    slot.clear();
+    tree.assign(entries.size() + 1, 0);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        slot[entries[i]] = i;
+        // 线性建树
+        size_t node = i + 1;
+        tree[node] += 1;
+        size_t parent = node + (node & (~node + 1));
+        if (parent < tree.size()) {
+            tree[parent] += tree[node];
+        }
+    }
+}
+
+bool HoldQueue::enqueue(int readerId) {
+    if (readerId == 0 || slot.count(readerId)) {
+        return false;
+    }
+
+    entries.push_back(readerId);
+    slot[readerId] = entries.size() - 1;
+
+    // 在树状数组末尾追加一个结点：它覆盖的区间为(n - lowbit(n), n]
+    size_t n = entries.size();
+    size_t low = n & (~n + 1);
+    tree.push_back(1 + prefixSum(n - 1) - prefixSum(n - low));
+    return true;
+}
+
+bool HoldQueue::cancel(int readerId) {
+    auto it = slot.find(readerId);
+    if (it == slot.end()) {
+        return false;
+    }
+
+    entries[it->second] = 0;
+    update(it->second, -1);
+    slot.erase(it);
+    compact();
+    return true;
+}
+
+int HoldQueue::pop() {
+    while (head < entries.size() && entries[head] == 0) {
+        ++head;
+    }
+    if (head == entries.size()) {
+        return 0;
+    }
+
+    // 出队的位置不必从树状数组中扣除：排队位置只统计队首之后的部分
+    int readerId = entries[head];
+    entries[head] = 0;
+    slot.erase(readerId);
+    ++head;
+    compact();
+    return readerId;
+}
+
+size_t HoldQueue::positionOf(int readerId) const {
+    auto it = slot.find(readerId);
+    if (it == slot.end()) {
+        return 0;
+    }
+    return prefixSum(it->second + 1) - prefixSum(head);
+}
+
+size_t HoldQueue::size() const {
+    return slot.size();
+}
+
+bool HoldQueue::empty() const {
+    return slot.empty();
+}
+
+std::vector<int> HoldQueue::readers() const {
+    std::vector<int> result;
+    for (size_t i = head; i < entries.size(); ++i) {
+        if (entries[i] != 0) {
+            result.push_back(entries[i]);
+        }
+    }
+    return result;
+}
+
+HoldQueues::HoldQueues() : logLines(0), liveHolds(0) {}
+
+void HoldQueues::append(char op, int titleId, int readerId) {
+    std::ofstream file(path, std::ios::app);
+    if (!file) {
+        return;
+    }
+    file << op << " " << logCopies[titleId] << " " << readerId << "\n";
+    ++logLines;
+}
+
+bool HoldQueues::applyReserve(int titleId, int bookId, int readerId) {
+    if (!queues[titleId].enqueue(readerId)) {
+        return false;
+    }
+    logCopies.emplace(titleId, bookId);
+    byReader[readerId].insert(titleId);
+    ++liveHolds;
+    return true;
+}
+
+// 队列空了就连同它在日志中的代表图书一起去掉
+void HoldQueues::eraseQueue(int titleId) {
+    queues.erase(titleId);
+    logCopies.erase(titleId);
+}
+
+bool HoldQueues::applyCancel(int titleId, int readerId) {
+    auto it = queues.find(titleId);
+    if (it == queues.end() || !it->second.cancel(readerId)) {
+        return false;
+    }
+    if (it->second.empty()) {
+        eraseQueue(titleId);
+    }
+
+    auto& titles = byReader[readerId];
+    titles.erase(titleId);
+    if (titles.empty()) {
+        byReader.erase(readerId);
+    }
+    --liveHolds;
+    return true;
+}
+
+int HoldQueues::applyPop(int titleId) {
+    auto it = queues.find(titleId);
+    if (it == queues.end()) {
+        return 0;
+    }
+
+    int readerId = it->second.pop();
+    if (it->second.empty()) {
+        eraseQueue(titleId);
+    }
+    if (readerId != 0) {
+        auto& titles = byReader[readerId];
+        titles.erase(titleId);
+        if (titles.empty()) {
+            byReader.erase(readerId);
+        }
+        --liveHolds;
+    }
+    return readerId;
+}
+
+void HoldQueues::applyDrop(int titleId) {
+    auto it = queues.find(titleId);
+    if (it == queues.end()) {
+        return;
+    }
+    for (int readerId : it->second.readers()) {
+        auto& titles = byReader[readerId];
+        titles.erase(titleId);
+        if (titles.empty()) {
+            byReader.erase(readerId);
+        }
+        --liveHolds;
+    }
+    eraseQueue(titleId);
+}
+
+void HoldQueues::compactIfNeeded() {
+    if (logLines > 1024 && logLines > 4 * liveHolds) {
+        compact();
+    }
+}
+
+void HoldQueues::load(const std::string& path, const std::function<int(int)>& titleOf) {
+    this->path = path;
+    queues.clear();
+    logCopies.clear();
+    byReader.clear();
+    logLines = 0;
+    liveHolds = 0;
+
+    std::ifstream file(path);
+    if (!file) {
+        return;
+    }
+
+    // 日志格式：操作 图书ID 读者ID
+    // R 预约  C 取消预约  P 队首出队（交接）  D 清空队列
+    // 图书已删除、或同一队列用了不同的图书ID（旧格式按册排队的日志）时，重放后重写日志
+    char op;
+    int bookId, readerId;
+    bool stale = false;
+    while (file >> op >> bookId >> readerId) {
+        ++logLines;
+        int titleId = titleOf(bookId);
+        if (titleId == 0) {
+            stale = true;
+            continue;
+        }
+        auto copy = logCopies.find(titleId);
+        if (copy != logCopies.end() && copy->second != bookId) {
+            stale = true;
+        }
+        switch (op) {
+            case 'R': applyReserve(titleId, bookId, readerId); break;
+            case 'C': applyCancel(titleId, readerId); break;
+            case 'P': applyPop(titleId); break;
+            case 'D': applyDrop(titleId); break;
+            default: break;
+        }
+    }
+    file.close();
+
+    if (stale) {
+        compact();
+    } else {
+        compactIfNeeded();
+    }
+}
+
+bool HoldQueues::compact() {
+    std::string tempPath = path + ".tmp";
+    std::ofstream file(tempPath);
+    if (!file) {
+        return false;
+    }
+
+    size_t lines = 0;
+    for (const auto& entry : queues) {
+        for (int readerId : entry.second.readers()) {
+            file << "R " << logCopies[entry.first] << " " << readerId << "\n";
+            ++lines;
+        }
+    }
+    file.close();
+    if (!file) {
+        return false;
+    }
+
+    std::remove(path.c_str());
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        return false;
+    }
+    logLines = lines;
+    return true;
+}
+
+bool HoldQueues::reserve(int titleId, int bookId, int readerId) {
+    if (!applyReserve(titleId, bookId, readerId)) {
+        return false;
+    }
+    append('R', titleId, readerId);
+    return true;
+}
+
+bool HoldQueues::cancel(int titleId, int readerId) {
+    // 日志行要在队列清空前按代表图书写出，先检查再写
+    if (positionOf(titleId, readerId) == 0) {
+        return false;
+    }
+    append('C', titleId, readerId);
+    applyCancel(titleId, readerId);
+    compactIfNeeded();
+    return true;
+}
+
+int HoldQueues::popNext(int titleId) {
+    auto it = queues.find(titleId);
+    if (it == queues.end() || it->second.empty()) {
+        return 0;
+    }
+    // 日志行要在队列清空前按代表图书写出，先写再出队
+    append('P', titleId, 0);
+    int readerId = applyPop(titleId);
+    compactIfNeeded();
+    return readerId;
+}
+
+void HoldQueues::removeCopy(int titleId, int bookId, int nextCopyId) {
+    auto it = logCopies.find(titleId);
+    if (it == logCopies.end() || it->second != bookId) {
+        return;
+    }
+    if (nextCopyId == 0) {
+        applyDrop(titleId);
+    } else {
+        it->second = nextCopyId;
+    }
+    // 日志中不能再留有这册图书的ID：它若被回收给别的书目，重放时会记到那个书目上
+    compact();
+}
+
+void HoldQueues::dropReader(int readerId) {
+    auto it = byReader.find(readerId);
+    if (it == byReader.end()) {
+        return;
+    }
+    std::vector<int> titles(it->second.begin(), it->second.end());
+    for (int titleId : titles) {
+        cancel(titleId, readerId);
+    }
+}
+
+size_t HoldQueues::positionOf(int titleId, int readerId) const {
+    auto it = queues.find(titleId);
+    if (it == queues.end()) {
+        return 0;
+    }
+    return it->second.positionOf(readerId);
+}
+
+size_t HoldQueues::queueLength(int titleId) const {
+    auto it = queues.find(titleId);
+    if (it == queues.end()) {
+        return 0;
+    }
+    return it->second.size();
+}
+
+std::vector<int> HoldQueues::reservationsOf(int readerId) const {
+    auto it = byReader.find(readerId);
+    if (it == byReader.end()) {
+        return std::vector<int>();
+    }
+    return std::vector<int>(it->second.begin(), it->second.end());
+}
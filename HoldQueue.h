@@ -0,0 +1,84 @@
+#ifndef HOLD_QUEUE_H
+#define HOLD_QUEUE_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
+// 一个书目的预约队列。
+// 入队、出队为O(1)（均摊），取消预约和查询排队位置为O(log n)：
+// 队列中每个位置是否仍有效记录在树状数组里，排队位置即前面有效位置的个数。
+class HoldQueue {
+private:
+    std::vector<int> entries;                   // 按预约顺序的读者ID，已取消的位置为0
+    std::vector<int> tree;                      // 树状数组（下标从1开始）
+    size_t head;                                // 队首位置
+    std::unordered_map<int, size_t> slot;       // 读者ID -> 在entries中的位置
+
+    int prefixSum(size_t count) const;          // 前count个位置中有效位置的个数
+    void update(size_t index, int delta);
+    void compact();
+
+public:
+    HoldQueue();
+
+    bool enqueue(int readerId);
+    bool cancel(int readerId);
+    // 取出队首读者，队列为空时返回0
+    int pop();
+    // 排队位置（从1开始），未预约时返回0
+    size_t positionOf(int readerId) const;
+    size_t size() const;
+    bool empty() const;
+    // 按排队顺序列出读者
+    std::vector<int> readers() const;
+};
+
+// 所有书目的预约队列：读者预约的是书目，任一册归还都交给该书目的队首读者。
+// 操作以追加方式写入日志文件，启动时重放。每次预约或交接只追加一行，不重写整个文件；
+// 日志膨胀后再整体压缩一次。书目ID在加载时分配、不写入文件，所以日志里记的是
+// 该书目的一册图书ID（每个队列固定用同一册），重放时再换成书目ID
+class HoldQueues {
+private:
+    std::unordered_map<int, HoldQueue> queues;                  // 书目ID -> 队列
+    std::unordered_map<int, int> logCopies;                     // 书目ID -> 日志中代表它的图书ID
+    std::unordered_map<int, std::unordered_set<int>> byReader;  // 读者ID -> 预约的书目ID
+    std::string path;
+    size_t logLines;                                            // 日志中的行数
+    size_t liveHolds;                                           // 当前有效的预约数
+
+    void append(char op, int titleId, int readerId);
+    bool applyReserve(int titleId, int bookId, int readerId);
+    bool applyCancel(int titleId, int readerId);
+    int applyPop(int titleId);
+    void applyDrop(int titleId);
+    void eraseQueue(int titleId);
+    void compactIfNeeded();
+
+public:
+    HoldQueues();
+
+    // 重放日志文件；titleOf把日志中的图书ID换成所属书目ID，图书已不存在时返回0，该行忽略
+    void load(const std::string& path, const std::function<int(int)>& titleOf);
+    // 把当前状态重写为紧凑的日志
+    bool compact();
+
+    // bookId是读者指定的那一册，队列新建时用它在日志中代表书目
+    bool reserve(int titleId, int bookId, int readerId);
+    bool cancel(int titleId, int readerId);
+    // 取出下一位预约读者，没有时返回0
+    int popNext(int titleId);
+    // 删除一册图书：它在日志中代表某个队列时改用nextCopyId并重写日志，
+    // nextCopyId为0（书目已没有副本）时清空该队列
+    void removeCopy(int titleId, int bookId, int nextCopyId);
+    // 读者被删除时取消该读者的所有预约
+    void dropReader(int readerId);
+
+    size_t positionOf(int titleId, int readerId) const;
+    size_t queueLength(int titleId) const;
+    std::vector<int> reservationsOf(int readerId) const;
+};
+
+#endif // HOLD_QUEUE_H
@@ -0,0 +1,82 @@
+#include "IdAllocator.h"
+#include <algorithm>
+#include <istream>
+#include <ostream>
+
+IdAllocator::IdAllocator()
+    : nextId(1), quarantine(static_cast<std::time_t>(DEFAULT_QUARANTINE_DAYS) * 24 * 3600) {}
+
+int IdAllocator::allocate(std::time_t now) {
+    // 队首回收得最早，它还在隔离期内时后面的也都在
+    if (quarantine >= 0 && !retired.empty() && now - retired.front().second >= quarantine) {
+        int id = retired.front().first;
+        retired.pop_front();
+        return id;
+    }
+    return nextId++;
+}
+
+void IdAllocator::release(int id, std::time_t now) {
+    if (id <= 0 || id >= nextId || quarantine < 0) {
+        return;
+    }
+    retired.emplace_back(id, now);
+}
+
+void IdAllocator::reserve(int id) {
+    if (id >= nextId) {
+        nextId = id + 1;
+        return;
+    }
+    auto it = std::find_if(retired.begin(), retired.end(), 
+                           [id](const std::pair<int, std::time_t>& entry) { return entry.first == id; });
+    if (it != retired.end()) {
+        retired.erase(it);
+    }
+}
+
+void IdAllocator::reset(int nextId) {
+    this->nextId = std::max(nextId, 1);
+    retired.clear();
+}
+
+void IdAllocator::setQuarantine(std::time_t seconds) {
+    quarantine = seconds;
+}
+
+int IdAllocator::getNextId() const {
+    return nextId;
+}
+
+size_t IdAllocator::retiredCount() const {
+    return retired.size();
+}
+
+bool IdAllocator::read(std::istream& is) {
+    int next;
+    size_t count;
+    if (!(is >> next >> count) || next < 1) {
+        return false;
+    }
+
+    std::deque<std::pair<int, std::time_t>> entries;
+    for (size_t i = 0; i < count; ++i) {
+        int id;
+        long long time;
+        if (!(is >> id >> time) || id <= 0 || id >= next) {
+            return false;
+        }
+        entries.emplace_back(id, static_cast<std::time_t>(time));
+    }
+
+    nextId = next;
+    retired.swap(entries);
+    return true;
+}
+
+void IdAllocator::write(std::ostream& os) const {
+    os << nextId << " " << retired.size() << "\n";
+    for (const auto& entry : retired) {
+        os << entry.first << " " << static_cast<long long>(entry.second) << "\n";
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef ID_ALLOCATOR_H
+#define ID_ALLOCATOR_H
+
+#include <algorithm>
+#include <ctime>
+#include <deque>
+#include <iosfwd>
+#include <utility>
+
+// ID分配器：优先复用已回收且过了隔离期的ID，否则分配下一个新ID，使ID保持紧凑。
+// 回收的ID先隔离一段时间再复用，避免仍引用旧ID的记录（通知单、导出文件等）被误认为新记录。
+// 状态单独保存，启动时直接读入，不必扫描全部记录求最大ID。
+class IdAllocator {
+private:
+    int nextId;
+    std::deque<std::pair<int, std::time_t>> retired;   // (ID, 回收时间)，按回收时间先后排列
+    std::time_t quarantine;                            // 隔离期（秒），小于0表示不复用
+
+public:
+    static const int DEFAULT_QUARANTINE_DAYS = 30;     // 默认隔离期（天）
+
+    IdAllocator();
+
+    int allocate(std::time_t now);
+    void release(int id, std::time_t now);
+    // 回收队列中满足条件的ID不再复用，pred以ID为参数；返回去掉的个数
+    template <typename Pred>
+    size_t discardRetired(Pred pred) {
+        size_t before = retired.size();
+        retired.erase(std::remove_if(retired.begin(), retired.end(),
+                                     [&pred](const std::pair<int, std::time_t>& entry) { return pred(entry.first); }),
+                      retired.end());
+        return before - retired.size();
+    }
+    // 外部指定的ID（如导入数据）已被占用
+    void reserve(int id);
+    // 按现有记录的最大ID重置（没有状态文件时使用）
+    void reset(int nextId);
+    void setQuarantine(std::time_t seconds);
+
+    int getNextId() const;
+    size_t retiredCount() const;
+
+    // 读写一段状态：第一行“下一个ID 回收数”，随后每行“ID 回收时间”
+    bool read(std::istream& is);
+    void write(std::ostream& os) const;
+};
+
+#endif // ID_ALLOCATOR_H
@@ -0,0 +1,528 @@
+#include "JsonLines.h"
+#include <charconv>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+void skipSpace(const char*& p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+        ++p;
+    }
+}
+
+bool expect(const char*& p, const char* end, char c) {
+    skipSpace(p, end);
+    if (p >= end || *p != c) {
+        return false;
+    }
+    ++p;
+    return true;
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool parseHex4(const char*& p, const char* end, unsigned& value) {
+    if (end - p < 4) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        int digit = hexValue(p[i]);
+        if (digit < 0) {
+            return false;
+        }
+        value = (value << 4) | static_cast<unsigned>(digit);
+    }
+    p += 4;
+    return true;
+}
+
+void appendUtf8(std::string& out, unsigned cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+// 解析字符串值到out（复用out的容量），p指向开头的引号
+bool parseString(const char*& p, const char* end, std::string& out) {
+    if (!expect(p, end, '"')) {
+        return false;
+    }
+    out.clear();
+    while (p < end) {
+        // 没有转义的连续片段整体追加
+        const char* start = p;
+        while (p < end && *p != '"' && *p != '\\') {
+            ++p;
+        }
+        out.append(start, p - start);
+        if (p >= end) {
+            return false;
+        }
+        if (*p == '"') {
+            ++p;
+            return true;
+        }
+
+        ++p;
+        if (p >= end) {
+            return false;
+        }
+        char c = *p++;
+        switch (c) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                unsigned cp;
+                if (!parseHex4(p, end, cp)) {
+                    return false;
+                }
+                // 代理对：高代理后必须紧跟低代理，单独的低代理不是合法字符
+                if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    return false;
+                }
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    unsigned low;
+                    if (end - p < 2 || p[0] != '\\' || p[1] != 'u') {
+                        return false;
+                    }
+                    p += 2;
+                    if (!parseHex4(p, end, low) || low < 0xDC00 || low > 0xDFFF) {
+                        return false;
+                    }
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, cp);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return false;
+}
+
+// 键名都很短，直接放进栈上的缓冲区
+bool parseKey(const char*& p, const char* end, char* key, size_t capacity) {
+    if (!expect(p, end, '"')) {
+        return false;
+    }
+    size_t n = 0;
+    while (p < end && *p != '"') {
+        if (*p == '\\' || n + 1 >= capacity) {
+            return false;
+        }
+        key[n++] = *p++;
+    }
+    if (p >= end) {
+        return false;
+    }
+    ++p;
+    key[n] = '\0';
+    return true;
+}
+
+bool parseInt(const char*& p, const char* end, int& value) {
+    skipSpace(p, end);
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    p = result.ptr;
+    return true;
+}
+
+bool parseBool(const char*& p, const char* end, bool& value) {
+    skipSpace(p, end);
+    if (end - p >= 4 && std::memcmp(p, "true", 4) == 0) {
+        value = true;
+        p += 4;
+        return true;
+    }
+    if (end - p >= 5 && std::memcmp(p, "false", 5) == 0) {
+        value = false;
+        p += 5;
+        return true;
+    }
+    // 兼容用0/1表示借阅状态
+    if (p < end && (*p == '0' || *p == '1')) {
+        value = (*p == '1');
+        ++p;
+        return true;
+    }
+    return false;
+}
+
+bool parseIntArray(const char*& p, const char* end, std::vector<int>& out) {
+    if (!expect(p, end, '[')) {
+        return false;
+    }
+    out.clear();
+    skipSpace(p, end);
+    if (p < end && *p == ']') {
+        ++p;
+        return true;
+    }
+    while (true) {
+        int value;
+        if (!parseInt(p, end, value)) {
+            return false;
+        }
+        out.push_back(value);
+        skipSpace(p, end);
+        if (p < end && *p == ',') {
+            ++p;
+            continue;
+        }
+        return expect(p, end, ']');
+    }
+}
+
+// 跳过不认识的字段值（允许其他系统附带额外字段）
+bool skipValue(const char*& p, const char* end) {
+    skipSpace(p, end);
+    if (p >= end) {
+        return false;
+    }
+    if (*p == '"') {
+        ++p;
+        while (p < end && *p != '"') {
+            if (*p == '\\') {
+                ++p;
+            }
+            ++p;
+        }
+        if (p >= end) {
+            return false;
+        }
+        ++p;
+        return true;
+    }
+    if (*p == '[' || *p == '{') {
+        int depth = 0;
+        while (p < end) {
+            char c = *p++;
+            if (c == '"') {
+                while (p < end && *p != '"') {
+                    if (*p == '\\') {
+                        ++p;
+                    }
+                    ++p;
+                }
+                if (p >= end) {
+                    return false;
+                }
+                ++p;
+            } else if (c == '[' || c == '{') {
+                ++depth;
+            } else if (c == ']' || c == '}') {
+                if (--depth == 0) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+    // 数字、true/false/null
+    const char* start = p;
+    while (p < end && *p != ',' && *p != '}' && *p != ']' &&
+           *p != ' ' && *p != '\t' && *p != '\r') {
+        ++p;
+    }
+    return p > start;
+}
+
+} // namespace
+
+void JsonRecord::clear() {
+    type.clear();
+    id = 0;
+    name.clear();
+    author.clear();
+    publisher.clear();
+    contact.clear();
+    borrowed = false;
+    loanLimit = Reader::DEFAULT_LOAN_LIMIT;
+    borrowedBooks.clear();
+}
+
+JsonLinesWriter::JsonLinesWriter(const std::string& path)
+    : file(path, std::ios::binary), used(0) {}
+
+JsonLinesWriter::~JsonLinesWriter() {
+    close();
+}
+
+bool JsonLinesWriter::isOpen() const {
+    return file.is_open();
+}
+
+void JsonLinesWriter::flushBuffer() {
+    if (used > 0) {
+        file.write(buffer, used);
+        used = 0;
+    }
+}
+
+void JsonLinesWriter::put(char c) {
+    if (used == BUFFER_SIZE) {
+        flushBuffer();
+    }
+    buffer[used++] = c;
+}
+
+void JsonLinesWriter::put(const char* s, size_t len) {
+    while (len > 0) {
+        if (used == BUFFER_SIZE) {
+            flushBuffer();
+        }
+        size_t n = std::min(len, BUFFER_SIZE - used);
+        std::memcpy(buffer + used, s, n);
+        used += n;
+        s += n;
+        len -= n;
+    }
+}
+
+void JsonLinesWriter::putInt(long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    put(digits, result.ptr - digits);
+}
+
+void JsonLinesWriter::putString(const std::string& s) {
+    static const char hex[] = "0123456789abcdef";
+    put('"');
+    const char* p = s.data();
+    const char* end = p + s.size();
+    while (p < end) {
+        // 不需要转义的连续片段（包括UTF-8多字节字符）整体复制
+        const char* start = p;
+        while (p < end && static_cast<unsigned char>(*p) >= 0x20 && *p != '"' && *p != '\\') {
+            ++p;
+        }
+        put(start, p - start);
+        if (p >= end) {
+            break;
+        }
+
+        char c = *p++;
+        switch (c) {
+            case '"': put("\\\"", 2); break;
+            case '\\': put("\\\\", 2); break;
+            case '\n': put("\\n", 2); break;
+            case '\r': put("\\r", 2); break;
+            case '\t': put("\\t", 2); break;
+            default: {
+                char escaped[6] = {'\\', 'u', '0', '0',
+                                   hex[(c >> 4) & 0xF], hex[c & 0xF]};
+                put(escaped, 6);
+                break;
+            }
+        }
+    }
+    put('"');
+}
+
+void JsonLinesWriter::write(const Book& book) {
+    static const char typeField[] = "{\"type\":\"book\",\"id\":";
+    put(typeField, sizeof(typeField) - 1);
+    putInt(book.getId());
+    put(",\"name\":", 8);
+    putString(book.getName());
+    put(",\"author\":", 10);
+    putString(book.getAuthor());
+    put(",\"publisher\":", 13);
+    putString(book.getPublisher());
+    if (book.isBorrowed()) {
+        put(",\"borrowed\":true}\n", 18);
+    } else {
+        put(",\"borrowed\":false}\n", 19);
+    }
+}
+
+void JsonLinesWriter::write(const Reader& reader) {
+    static const char typeField[] = "{\"type\":\"reader\",\"id\":";
+    put(typeField, sizeof(typeField) - 1);
+    putInt(reader.getId());
+    put(",\"name\":", 8);
+    putString(reader.getName());
+    put(",\"contact\":", 11);
+    putString(reader.getContact());
+    put(",\"loanLimit\":", 13);
+    putInt(reader.getLoanLimit());
+    put(",\"borrowedBooks\":[", 18);
+    const Reader::BookList& borrowedBooks = reader.getBorrowedBooks();
+    for (size_t i = 0; i < borrowedBooks.size(); ++i) {
+        if (i > 0) {
+            put(',');
+        }
+        putInt(borrowedBooks[i]);
+    }
+    put("]}\n", 3);
+}
+
+bool JsonLinesWriter::close() {
+    if (!file.is_open()) {
+        return true;
+    }
+    flushBuffer();
+    bool ok = static_cast<bool>(file);
+    file.close();
+    return ok;
+}
+
+JsonLinesReader::JsonLinesReader(const std::string& path)
+    : file(path, std::ios::binary), pos(0), len(0), lineNumber(0) {}
+
+bool JsonLinesReader::isOpen() const {
+    return file.is_open();
+}
+
+bool JsonLinesReader::readLine() {
+    line.clear();
+    while (true) {
+        if (pos == len) {
+            if (!file) {
+                return !line.empty();
+            }
+            file.read(buffer, BUFFER_SIZE);
+            len = static_cast<size_t>(file.gcount());
+            pos = 0;
+            if (len == 0) {
+                return !line.empty();
+            }
+        }
+        const char* start = buffer + pos;
+        const char* newline = static_cast<const char*>(std::memchr(start, '\n', len - pos));
+        if (newline) {
+            line.append(start, newline - start);
+            pos = newline - buffer + 1;
+            return true;
+        }
+        line.append(start, len - pos);
+        pos = len;
+    }
+}
+
+bool JsonLinesReader::parseLine(const char* p, const char* end, JsonRecord& record) {
+    record.clear();
+    if (!expect(p, end, '{')) {
+        error = "缺少 '{'";
+        return false;
+    }
+    skipSpace(p, end);
+    if (p < end && *p == '}') {
+        error = "空对象";
+        return false;
+    }
+
+    bool hasId = false;
+    while (true) {
+        char key[32];
+        if (!parseKey(p, end, key, sizeof(key)) || !expect(p, end, ':')) {
+            error = "字段名格式错误";
+            return false;
+        }
+
+        bool ok;
+        if (std::strcmp(key, "type") == 0) {
+            ok = parseString(p, end, record.type);
+        } else if (std::strcmp(key, "id") == 0) {
+            ok = parseInt(p, end, record.id);
+            hasId = ok;
+        } else if (std::strcmp(key, "name") == 0) {
+            ok = parseString(p, end, record.name);
+        } else if (std::strcmp(key, "author") == 0) {
+            ok = parseString(p, end, record.author);
+        } else if (std::strcmp(key, "publisher") == 0) {
+            ok = parseString(p, end, record.publisher);
+        } else if (std::strcmp(key, "contact") == 0) {
+            ok = parseString(p, end, record.contact);
+        } else if (std::strcmp(key, "borrowed") == 0) {
+            ok = parseBool(p, end, record.borrowed);
+        } else if (std::strcmp(key, "loanLimit") == 0) {
+            ok = parseInt(p, end, record.loanLimit) && record.loanLimit > 0;
+        } else if (std::strcmp(key, "borrowedBooks") == 0) {
+            ok = parseIntArray(p, end, record.borrowedBooks);
+        } else {
+            ok = skipValue(p, end);
+        }
+        if (!ok) {
+            error = std::string("字段 ") + key + " 的值格式错误";
+            return false;
+        }
+
+        skipSpace(p, end);
+        if (p < end && *p == ',') {
+            ++p;
+            continue;
+        }
+        if (!expect(p, end, '}')) {
+            error = "缺少 '}'";
+            return false;
+        }
+        break;
+    }
+
+    skipSpace(p, end);
+    if (p != end) {
+        error = "对象之后有多余内容";
+        return false;
+    }
+    if (record.type != "book" && record.type != "reader") {
+        error = "未知的记录类型";
+        return false;
+    }
+    if (!hasId) {
+        error = "缺少 id 字段";
+        return false;
+    }
+    return true;
+}
+
+bool JsonLinesReader::next(JsonRecord& record) {
+    while (readLine()) {
+        ++lineNumber;
+        const char* p = line.data();
+        const char* end = p + line.size();
+        skipSpace(p, end);
+        if (p == end) {
+            continue; // 空行
+        }
+        return parseLine(p, end, record);
+    }
+    return false;
+}
+
+size_t JsonLinesReader::getLineNumber() const {
+    return lineNumber;
+}
+
+const std::string& JsonLinesReader::getError() const {
+    return error;
+}
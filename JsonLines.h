@@ -0,0 +1,76 @@
+#ifndef JSON_LINES_H
+#define JSON_LINES_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include "Book.h"
+#include "Reader.h"
+
+// JSON Lines 记录（一行一个对象），导入时逐行复用，避免反复分配内存
+struct JsonRecord {
+    std::string type;                // "book" 或 "reader"
+    int id;
+    std::string name;
+    std::string author;
+    std::string publisher;
+    std::string contact;
+    bool borrowed;
+    int loanLimit;
+    std::vector<int> borrowedBooks;
+
+    void clear();
+};
+
+// 流式写出：固定大小的缓冲区，写满即刷新到文件，不构造中间字符串
+class JsonLinesWriter {
+private:
+    static const size_t BUFFER_SIZE = 1 << 16;
+
+    std::ofstream file;
+    char buffer[BUFFER_SIZE];
+    size_t used;
+
+    void flushBuffer();
+    void put(char c);
+    void put(const char* s, size_t len);
+    void putInt(long long value);
+    void putString(const std::string& s);
+
+public:
+    explicit JsonLinesWriter(const std::string& path);
+    ~JsonLinesWriter();
+
+    bool isOpen() const;
+    void write(const Book& book);
+    void write(const Reader& reader);
+    bool close();
+};
+
+// 流式读取：按块读入文件，逐行单遍解析，内存占用只与最长的一行有关
+class JsonLinesReader {
+private:
+    static const size_t BUFFER_SIZE = 1 << 16;
+
+    std::ifstream file;
+    char buffer[BUFFER_SIZE];
+    size_t pos;
+    size_t len;
+    std::string line;                // 跨块的行在此拼接，容量复用
+    size_t lineNumber;
+    std::string error;
+
+    bool readLine();
+    bool parseLine(const char* p, const char* end, JsonRecord& record);
+
+public:
+    explicit JsonLinesReader(const std::string& path);
+
+    bool isOpen() const;
+    // 读取下一条记录；到达文件末尾或出错时返回false，出错时getError()非空
+    bool next(JsonRecord& record);
+    size_t getLineNumber() const;
+    const std::string& getError() const;
+};
+
+#endif // JSON_LINES_H
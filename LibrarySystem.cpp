@@ -1,44 +1,264 @@
 #include "LibrarySystem.h"
+#include "JsonLines.h"
+#include "PostingLists.h"
+#include "RecordParser.h"
+#include "TextFold.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
 #include <limits>
+#include <unordered_map>
+#include <cstring>
+#include <future>
+#include <ctime>
+#include <sstream>
 
-LibrarySystem::LibrarySystem(const std::string& bookFile, const std::string& readerFile)
-    : bookFile(bookFile), readerFile(readerFile), nextBookId(1), nextReaderId(1) {
-    loadBooks();
-    loadReaders();
+namespace {
+
+// 数据文件中每条记录固定占用的行数（图书与读者均为5行）
+const size_t RECORD_LINES = 5;
+
+// 分页查找时每页显示的条数
+const size_t PAGE_SIZE = 10;
+
+// 导入的记录ID最多比已分配的最大ID大这么多，超出的视为无效：表按ID直接寻址，
+// 一条ID畸大的记录就会让整张表跟着扩容
+const int IMPORT_ID_SLACK = 1 << 16;
+
+// 相关度排序时书名、作者、出版社的字段权重
+const double NAME_WEIGHT = 3.0;
+const double AUTHOR_WEIGHT = 2.0;
+const double PUBLISHER_WEIGHT = 1.0;
+
+bool readWholeFile(const std::string& path, std::string& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    
+    data.resize(static_cast<size_t>(size));
+    file.read(&data[0], size);
+    data.resize(static_cast<size_t>(file.gcount()));
+    return true;
+}
+
+// 一段连续的完整记录
+struct Chunk {
+    size_t begin;
+    size_t end;
+    size_t firstLine;        // 段首所在的行号（从1开始）
+};
+
+// 把文件切成若干段，每段都从记录开头开始。
+// 先并行统计每个块中的换行数，前缀和得到每个块开头所在的行号，
+// 再从块开头向后找到第一个行号为RECORD_LINES整数倍的行作为段起点。
+std::vector<Chunk> splitAtRecords(const std::string& data, ThreadPool& pool) {
+    std::vector<Chunk> chunks;
+    if (data.empty()) {
+        return chunks;
+    }
+    
+    size_t blockCount = std::max<size_t>(1, pool.size() * 4);
+    size_t blockSize = data.size() / blockCount + 1;
+    
+    std::vector<std::future<size_t>> counts;
+    for (size_t b = 0; b < blockCount; ++b) {
+        size_t begin = std::min(data.size(), b * blockSize);
+        size_t end = std::min(data.size(), begin + blockSize);
+        counts.push_back(pool.submit([&data, begin, end]() {
+            return static_cast<size_t>(std::count(data.begin() + begin, data.begin() + end, '\n'));
+        }));
+    }
+    
+    Chunk current = {0, 0, 1};
+    size_t lines = 0;
+    for (size_t b = 0; b < blockCount; ++b) {
+        size_t begin = std::min(data.size(), b * blockSize);
+        if (b > 0) {
+            // 块开头之前共有lines个换行
+            size_t pos = begin;
+            size_t line = lines;
+            bool atLineStart = data[pos - 1] == '\n';
+            while (pos < data.size() && !(atLineStart && line % RECORD_LINES == 0)) {
+                const char* newline = static_cast<const char*>(
+                    std::memchr(data.data() + pos, '\n', data.size() - pos));
+                if (!newline) {
+                    pos = data.size();
+                    break;
+                }
+                pos = newline - data.data() + 1;
+                ++line;
+                atLineStart = true;
+            }
+            if (pos > current.begin) {
+                current.end = pos;
+                chunks.push_back(current);
+                current = {pos, 0, line + 1};
+            }
+        }
+        lines += counts[b].get();
+    }
+    if (current.begin < data.size()) {
+        current.end = data.size();
+        chunks.push_back(current);
+    }
+    return chunks;
+}
+
+template <typename T>
+struct ParsedChunk {
+    std::vector<T> records;
+    size_t errorLine;
+    std::string error;
+};
+
+// 并行解析各段，按原顺序合并；遇到格式错误时只保留出错位置之前的记录
+template <typename T>
+bool parseRecords(const std::string& data, ThreadPool& pool, std::vector<T>& records,
+                  size_t& errorLine, std::string& error) {
+    std::vector<Chunk> chunks = splitAtRecords(data, pool);
+    
+    std::vector<std::future<ParsedChunk<T>>> parts;
+    for (const Chunk& chunk : chunks) {
+        parts.push_back(pool.submit([&data, chunk]() {
+            ParsedChunk<T> part;
+            part.errorLine = 0;
+            RecordParser parser(data.data() + chunk.begin, data.data() + chunk.end, chunk.firstLine);
+            while (!parser.atEnd()) {
+                T record;
+                if (!parser.parse(record)) {
+                    part.errorLine = parser.getLine();
+                    part.error = parser.getError();
+                    break;
+                }
+                part.records.push_back(std::move(record));
+            }
+            return part;
+        }));
+    }
+    
+    records.clear();
+    bool ok = true;
+    for (auto& future : parts) {
+        ParsedChunk<T> part = future.get();
+        if (!ok) {
+            continue;
+        }
+        if (records.empty()) {
+            records = std::move(part.records);
+        } else {
+            records.insert(records.end(), std::make_move_iterator(part.records.begin()),
+                           std::make_move_iterator(part.records.end()));
+        }
+        if (!part.error.empty()) {
+            ok = false;
+            errorLine = part.errorLine;
+            error = part.error;
+        }
+    }
+    return ok;
+}
+
+// 姓名或联系方式中包含关键字（需已经foldText规范化）；name、contact为复用的缓冲区
+bool readerMatches(const Reader& reader, const std::string& keyword, std::string& name, std::string& contact) {
+    foldText(reader.getName(), name);
+    if (name.find(keyword) != std::string::npos) {
+        return true;
+    }
+    foldText(reader.getContact(), contact);
+    return contact.find(keyword) != std::string::npos;
+}
+
+// 按64条一批对候选运行谓词程序，满足的ID按升序追加到ids。
+// leaf(指令, lanes, 字下标)返回lanes中满足条件的记录；各条件事先求成位图，
+// leaf只取位图中的一个字，程序对整字做与、或、非
+template <typename Leaf>
+size_t runProgram(const QueryProgram& program, const BitSet& candidates, Leaf leaf, std::vector<int>& ids) {
+    size_t batches = 0;
+    for (size_t w = 0; w < candidates.wordCount(); ++w) {
+        std::uint64_t lanes = candidates.word(w);
+        if (lanes == 0) {
+            continue;
+        }
+        ++batches;
+        std::uint64_t hits = program.run(lanes, [&leaf, w](const QueryProgram::Instruction& instruction,
+                                                           std::uint64_t active) {
+            return leaf(instruction, active, w);
+        });
+        for (size_t bit = 0; hits != 0; ++bit, hits >>= 1) {
+            if (hits & 1) {
+                ids.push_back(static_cast<int>(w * 64 + bit));
+            }
+        }
+    }
+    return batches;
+}
+
+// ID条件：只可能命中第w个字中的一位
+std::uint64_t idLane(int id, size_t w) {
+    size_t index = static_cast<size_t>(id);
+    return index / 64 == w ? std::uint64_t(1) << (index % 64) : 0;
+}
+
+} // namespace
+
+LibrarySystem::LibrarySystem(const std::string& bookFile, const std::string& readerFile,
+                             const std::string& loanFile, const std::string& holdFile,
+                             const std::string& historyFile, const std::string& idFile)
+    : titleTerms({NAME_WEIGHT, AUTHOR_WEIGHT, PUBLISHER_WEIGHT}), searchIndexesReady(false),
+      sortedViewsReady(false), bookFile(bookFile), readerFile(readerFile), loanFile(loanFile), holdFile(holdFile),
+      historyFile(historyFile), idFile(idFile), statsWindowStart(0) {
+    // 图书和读者两个文件同时加载，各自再分段并行解析；线程池只在加载期间存在。
+    // 两边只写各自的表和索引，书目和延迟建立的索引要等两边都加载完再统一重建
+    {
+        ThreadPool pool;
+        std::future<void> readersLoaded = std::async(std::launch::async, [this, &pool]() { loadReaders(pool); });
+        loadBooks(pool);
+        readersLoaded.get();
+    }
+    rebuildTitles();
+    history.open(historyFile);
+    loadIds();
+    loadLoans();
+    holds.load(holdFile, [this](int bookId) {
+        const Book* book = findBook(bookId);
+        return book ? book->getTitle()->getId() : 0;
+    });
+    rebuildPopularity();
+    rebuildRecommendations();
 }
 
 LibrarySystem::~LibrarySystem() {
     saveBooks();
     saveReaders();
+    saveLoans();
+    holds.compact();
+    history.saveHeads();
 }
 
 
-void LibrarySystem::loadBooks() {
-    std::ifstream file(bookFile);
-    if (!file) {
+void LibrarySystem::loadBooks(ThreadPool& pool) {
+    std::string data;
+    if (!readWholeFile(bookFile, data)) {
         std::cout << "图书文件不存在，将创建新文件。" << std::endl;
         return;
     }
     
-    books.clear();
-    nextBookId = 1;
-    
-    while (!file.eof()) {
-        Book book;
-        file >> book;
-        
-        if (file.fail()) {
-            break;
-        }
-        
-        books.push_back(book);
-        nextBookId = std::max(nextBookId, book.getId() + 1);
+    size_t errorLine;
+    std::string error;
+    std::vector<Book> records;
+    if (!parseRecords(data, pool, records, errorLine, error)) {
+        std::cout << "图书文件第 " << errorLine << " 行格式错误：" << error 
+                  << "，之后的记录未加载。" << std::endl;
+    }
+    size_t skipped = books.assign(std::move(records));
+    if (skipped > 0) {
+        std::cout << "图书文件中有 " << skipped << " 条记录的ID无效或重复，已跳过。" << std::endl;
     }
-    
-    file.close();
 }
 
 void LibrarySystem::saveBooks() {
@@ -48,39 +268,101 @@ void LibrarySystem::saveBooks() {
         return;
     }
     
-    for (size_t i = 0; i < books.size(); ++i) {
-        file << books[i];
-        if (i < books.size() - 1) {
+    bool first = true;
+    for (const Book& book : books) {
+        if (!first) {
             file << "\n";
         }
+        file << book;
+        first = false;
     }
     
     file.close();
 }
 
-void LibrarySystem::loadReaders() {
-    std::ifstream file(readerFile);
-    if (!file) {
+void LibrarySystem::loadReaders(ThreadPool& pool) {
+    std::string data;
+    if (!readWholeFile(readerFile, data)) {
         std::cout << "读者文件不存在，将创建新文件。" << std::endl;
         return;
     }
     
-    readers.clear();
-    nextReaderId = 1;
-    
-    while (!file.eof()) {
-        Reader reader;
-        file >> reader;
-        
-        if (file.fail()) {
-            break;
+    size_t errorLine;
+    std::string error;
+    std::vector<Reader> records;
+    if (!parseRecords(data, pool, records, errorLine, error)) {
+        std::cout << "读者文件第 " << errorLine << " 行格式错误：" << error 
+                  << "，之后的记录未加载。" << std::endl;
+    }
+    size_t skipped = readers.assign(std::move(records));
+    if (skipped > 0) {
+        std::cout << "读者文件中有 " << skipped << " 条记录的ID无效或重复，已跳过。" << std::endl;
+    }
+    readerNames.clear();
+    readerPinyin.clear();
+    readerView.clear();
+    for (const Reader& reader : readers) {
+        readerNames.insert(reader.getName());
+    }
+}
+
+// ID分配状态单独保存；文件不存在或损坏时才按现有记录的最大ID恢复
+void LibrarySystem::loadIds() {
+    std::ifstream file(idFile);
+    std::string bookTag, readerTag;
+    if (file && file >> bookTag && bookTag == "book" && bookIds.read(file) &&
+        file >> readerTag && readerTag == "reader" && readerIds.read(file)) {
+        // 状态文件可能比数据文件旧（如单独恢复了book.dat）：数据中已有的ID都标为占用，
+        // 有借还历史的ID也不再复用，免得新记录接上旧记录的历史
+        int bookNext = bookIds.getNextId();
+        int readerNext = readerIds.getNextId();
+        int maxBookId = 0;
+        for (const Book& book : books) {
+            maxBookId = std::max(maxBookId, book.getId());
         }
-        
-        readers.push_back(reader);
+        int maxReaderId = 0;
+        for (const Reader& reader : readers) {
+            maxReaderId = std::max(maxReaderId, reader.getId());
+        }
+        bookIds.reserve(maxBookId);
+        readerIds.reserve(maxReaderId);
+        size_t discarded = bookIds.discardRetired([this](int id) {
+            return books.contains(id) || history.hasBookHistory(id);
+        });
+        discarded += readerIds.discardRetired([this](int id) {
+            return readers.contains(id) || history.hasReaderHistory(id);
+        });
+        if (discarded > 0 || bookIds.getNextId() != bookNext || readerIds.getNextId() != readerNext) {
+            std::cout << "ID分配信息与数据文件不一致，已按数据文件修正。" << std::endl;
+            saveIds();
+        }
+        return;
+    }
+    
+    int nextBookId = 1;
+    for (const Book& book : books) {
+        nextBookId = std::max(nextBookId, book.getId() + 1);
+    }
+    int nextReaderId = 1;
+    for (const Reader& reader : readers) {
         nextReaderId = std::max(nextReaderId, reader.getId() + 1);
     }
+    bookIds.reset(nextBookId);
+    readerIds.reset(nextReaderId);
+    saveIds();
+}
+
+void LibrarySystem::saveIds() {
+    std::ofstream file(idFile);
+    if (!file) {
+        std::cout << "无法保存ID分配信息！" << std::endl;
+        return;
+    }
     
-    file.close();
+    file << "book\n";
+    bookIds.write(file);
+    file << "reader\n";
+    readerIds.write(file);
 }
 
 void LibrarySystem::saveReaders() {
@@ -90,236 +372,1581 @@ void LibrarySystem::saveReaders() {
         return;
     }
     
-    for (size_t i = 0; i < readers.size(); ++i) {
-        file << readers[i];
-        if (i < readers.size() - 1) {
+    bool first = true;
+    for (const Reader& reader : readers) {
+        if (!first) {
             file << "\n";
         }
+        file << reader;
+        first = false;
     }
     
     file.close();
 }
 
-int LibrarySystem::findBookIndex(int id) const {
-    for (size_t i = 0; i < books.size(); ++i) {
-        if (books[i].getId() == id) {
-            return i;
-        }
+void LibrarySystem::loadLoans() {
+    loans.load(loanFile);
+    syncLoans();
+}
+
+void LibrarySystem::saveLoans() {
+    if (!loans.save(loanFile)) {
+        std::cout << "无法保存借阅记录！" << std::endl;
+    }
+}
+
+// 让借阅记录与读者的已借图书列表一致：
+// 去掉对不上的记录，旧数据中没有借阅记录的已借图书从现在开始计算借期
+void LibrarySystem::syncLoans() {
+    LoanSchedule synced;
+    std::time_t now = std::time(nullptr);
+    
+    for (const Reader& reader : readers) {
+        for (int bookId : reader.getBorrowedBooks()) {
+            const Loan* loan = loans.find(bookId);
+            if (loan && loan->readerId == reader.getId()) {
+                synced.add(*loan);
+            } else {
+                synced.add({bookId, reader.getId(), now, 
+                            now + LoanSchedule::DEFAULT_LOAN_DAYS * 24 * 3600, false});
+            }
+        }
+    }
+    
+    loans = synced;
+}
+
+// 导入后核对借阅关系：每本书只归一位读者——借阅记录中的读者优先，其余按读者ID顺序
+// 归第一个列出它且未达借阅上限的读者；读者名下不存在、归了别人或重复列出的图书都去掉，
+// 再按各读者的借阅列表重设图书的借出标记
+void LibrarySystem::reconcileLoans() {
+    std::vector<int> holder(books.getLive().size(), 0);      // 按图书ID，这本书归哪位读者
+    std::vector<size_t> held(readers.getLive().size(), 0);   // 按读者ID，已归他的册数
+    for (const Reader& reader : readers) {
+        for (int bookId : reader.getBorrowedBooks()) {
+            const Loan* loan = books.contains(bookId) ? loans.find(bookId) : nullptr;
+            if (loan && loan->readerId == reader.getId() && holder[bookId] == 0 &&
+                held[reader.getId()] < static_cast<size_t>(reader.getLoanLimit())) {
+                holder[bookId] = reader.getId();
+                ++held[reader.getId()];
+            }
+        }
+    }
+    for (const Reader& reader : readers) {
+        for (int bookId : reader.getBorrowedBooks()) {
+            if (books.contains(bookId) && holder[bookId] == 0 &&
+                held[reader.getId()] < static_cast<size_t>(reader.getLoanLimit())) {
+                holder[bookId] = reader.getId();
+                ++held[reader.getId()];
+            }
+        }
+    }
+    
+    size_t dropped = 0;
+    for (Reader& reader : readers) {
+        const Reader::BookList& borrowedBooks = reader.getBorrowedBooks();
+        std::vector<int> kept;
+        for (int bookId : borrowedBooks) {
+            if (books.contains(bookId) && holder[bookId] == reader.getId() &&
+                std::find(kept.begin(), kept.end(), bookId) == kept.end()) {
+                kept.push_back(bookId);
+            }
+        }
+        if (kept.size() != borrowedBooks.size()) {
+            dropped += borrowedBooks.size() - kept.size();
+            reader.setBorrowedBooks(kept);
+        }
+    }
+    
+    size_t corrected = 0;
+    for (Book& book : books) {
+        bool borrowed = holder[book.getId()] != 0;
+        if (book.isBorrowed() != borrowed) {
+            setBorrowed(book, borrowed);
+            ++corrected;
+        }
+    }
+    
+    if (dropped > 0 || corrected > 0) {
+        std::cout << "导入数据的借阅信息不一致：去掉了 " << dropped << " 条读者借阅记录，修正了 " 
+                  << corrected << " 本图书的借出状态。" << std::endl;
+    }
+}
+
+const Book* LibrarySystem::findBook(int id) const {
+    return books.find(id);
+}
+
+const Reader* LibrarySystem::findReader(int id) const {
+    return readers.find(id);
+}
+
+std::string LibrarySystem::titleKey(const std::string& name, const std::string& author, 
+                                    const std::string& publisher) {
+    return name + '\x1f' + author + '\x1f' + publisher;
+}
+
+// 把图书挂到同名同作者同出版社的书目下，没有时新建书目
+void LibrarySystem::attachTitle(Book& book) {
+    const std::shared_ptr<Title>& own = book.getTitle();
+    std::string key = titleKey(own->getName(), own->getAuthor(), own->getPublisher());
+    
+    std::shared_ptr<Title> title;
+    auto it = titleIndex.find(key);
+    if (it != titleIndex.end()) {
+        title = titles[it->second];
+        queryCache.invalidateTitle(it->second, false);
+    } else {
+        int titleId = static_cast<int>(titles.size());
+        title = std::make_shared<Title>(titleId, own->getName(), own->getAuthor(), own->getPublisher());
+        titles.push_back(title);
+        titleIndex[key] = titleId;
+        titleText.add(titleId, {&title->getName(), &title->getAuthor(), &title->getPublisher()});
+        if (searchIndexesReady) {
+            titleTerms.add(titleId, {&title->getName(), &title->getAuthor(), &title->getPublisher()});
+            titleFuzzy.add(titleId, {&title->getName(), &title->getAuthor(), &title->getPublisher()});
+            titlePinyin.add(titleId, {&title->getName(), &title->getAuthor()});
+        }
+        titleNames.insert(title->getName());
+        authorNames.insert(title->getAuthor());
+        authorFacets.assign(titleId, title->getAuthor());
+        publisherFacets.assign(titleId, title->getPublisher());
+        
+        // 新书目只会出现在关键字能匹配到它的查询结果中
+        std::string name = foldText(title->getName());
+        std::string author = foldText(title->getAuthor());
+        std::string publisher = foldText(title->getPublisher());
+        queryCache.invalidateIf([&](const QueryCache::Entry& entry) {
+            return name.find(entry.keyword) != std::string::npos ||
+                   author.find(entry.keyword) != std::string::npos ||
+                   publisher.find(entry.keyword) != std::string::npos;
+        });
+    }
+    
+    title->addCopy(book.getId(), book.isBorrowed());
+    authorFacets.addCopy(title->getId(), book.isBorrowed());
+    publisherFacets.addCopy(title->getId(), book.isBorrowed());
+    book.setTitle(title);
+    borrowedBits.assign(book.getId(), book.isBorrowed());
+    addToSortedViews(book);
+}
+
+// 从书目中去掉这一册，书目没有副本时一并删除
+void LibrarySystem::detachTitle(Book& book) {
+    const std::shared_ptr<Title>& title = book.getTitle();
+    if (title->getId() == 0) {
+        return;
+    }
+    
+    int titleId = title->getId();
+    title->removeCopy(book.getId(), book.isBorrowed());
+    authorFacets.removeCopy(titleId, book.isBorrowed());
+    publisherFacets.removeCopy(titleId, book.isBorrowed());
+    removeFromSortedViews(book);
+    queryCache.invalidateTitle(titleId, false);
+    borrowedBits.reset(book.getId());
+    if (title->getTotalCopies() == 0) {
+        titleIndex.erase(titleKey(title->getName(), title->getAuthor(), title->getPublisher()));
+        titleText.remove(titleId);
+        if (searchIndexesReady) {
+            titleTerms.remove(titleId);
+            titleFuzzy.remove(titleId);
+            titlePinyin.remove(titleId);
+        }
+        titleNames.remove(title->getName());
+        authorNames.remove(title->getAuthor());
+        titles[titleId] = nullptr;
+    }
+}
+
+void LibrarySystem::rebuildTitles() {
+    titles.assign(1, nullptr);   // 书目ID从1开始
+    titleIndex.clear();
+    titleText.clear();
+    queryCache.clear();
+    titleTerms.clear();
+    titleFuzzy.clear();
+    titlePinyin.clear();
+    searchIndexesReady = false;
+    for (SortedView& view : bookViews) {
+        view.clear();
+    }
+    sortedViewsReady = false;
+    titleNames.clear();
+    authorNames.clear();
+    authorFacets.clear();
+    publisherFacets.clear();
+    borrowedBits = BitSet(books.getLive().size());
+    titleIndex.reserve(books.size());
+    for (Book& book : books) {
+        attachTitle(book);
+    }
+}
+
+// 相关度、容错和拼音索引建立较慢，不在启动时建立，等到第一次用到时再建
+void LibrarySystem::buildSearchIndexes() const {
+    if (searchIndexesReady) {
+        return;
+    }
+    for (const std::shared_ptr<Title>& title : titles) {
+        if (title) {
+            titleTerms.add(title->getId(), {&title->getName(), &title->getAuthor(), &title->getPublisher()});
+            titleFuzzy.add(title->getId(), {&title->getName(), &title->getAuthor(), &title->getPublisher()});
+            titlePinyin.add(title->getId(), {&title->getName(), &title->getAuthor()});
+        }
+    }
+    for (const Reader& reader : readers) {
+        readerPinyin.add(reader.getId(), {&reader.getName()});
+    }
+    searchIndexesReady = true;
+}
+
+// 排序视图的排序键要逐条转写拼音，同样等到第一次按名称排序浏览时再建
+void LibrarySystem::buildSortedViews() const {
+    if (sortedViewsReady) {
+        return;
+    }
+    sortedViewsReady = true;
+    for (const Book& book : books) {
+        addToSortedViews(book);
+    }
+    std::string key;
+    for (const Reader& reader : readers) {
+        collationKey(reader.getName(), key);
+        readerView.insert(key, reader.getId());
+    }
+}
+
+void LibrarySystem::addToSortedViews(const Book& book) const {
+    if (!sortedViewsReady) {
+        return;
+    }
+    std::string key;
+    const std::string* fields[] = {&book.getName(), &book.getAuthor(), &book.getPublisher()};
+    for (size_t i = 0; i < 3; ++i) {
+        collationKey(*fields[i], key);
+        bookViews[i].insert(key, book.getId());
+    }
+}
+
+void LibrarySystem::removeFromSortedViews(const Book& book) const {
+    if (!sortedViewsReady) {
+        return;
+    }
+    std::string key;
+    const std::string* fields[] = {&book.getName(), &book.getAuthor(), &book.getPublisher()};
+    for (size_t i = 0; i < 3; ++i) {
+        collationKey(*fields[i], key);
+        bookViews[i].erase(key, book.getId());
+    }
+}
+
+bool LibrarySystem::addBook(const std::string& name, const std::string& author, const std::string& publisher,
+                            int copies) {
+    if (copies <= 0) {
+        return false;
+    }
+    
+    // 先保存ID分配状态再保存图书，中途退出最多留下未用的ID，不会重复分配
+    std::time_t now = std::time(nullptr);
+    bool handedOff = false;
+    for (int i = 0; i < copies; ++i) {
+        Book* book = books.insert(Book(bookIds.allocate(now), name, author, publisher));
+        if (!book) {
+            std::cout << "分配的图书ID已被占用，只添加了 " << i << " 册！" << std::endl;
+            saveIds();
+            saveBooks();
+            return false;
+        }
+        attachTitle(*book);
+        // 新增的副本先交给该书目的预约读者
+        if (holds.queueLength(book->getTitle()->getId()) > 0) {
+            handOffToHolder(*book);
+            handedOff = true;
+        }
+    }
+    saveIds();
+    saveBooks();
+    if (handedOff) {
+        saveReaders();
+        saveLoans();
+    }
+    return true;
+}
+
+bool LibrarySystem::removeBook(int id) {
+    Book* book = books.find(id);
+    if (!book) {
+        return false;
+    }
+    
+    // 检查是否有读者借了这本书
+    for (const Reader& reader : readers) {
+        const Reader::BookList& borrowedBooks = reader.getBorrowedBooks();
+        if (std::find(borrowedBooks.begin(), borrowedBooks.end(), id) != borrowedBooks.end()) {
+            std::cout << "该书已被借出，无法删除！" << std::endl;
+            return false;
+        }
+    }
+    
+    std::shared_ptr<Title> title = book->getTitle();
+    detachTitle(*book);
+    books.erase(id);
+    holds.removeCopy(title->getId(), id, title->getTotalCopies() > 0 ? title->getCopyIds().front() : 0);
+    saveBooks();
+    // 借阅过的图书ID留在历史中，不再复用
+    if (!history.hasBookHistory(id)) {
+        bookIds.release(id, std::time(nullptr));
+    }
+    saveIds();
+    return true;
+}
+
+Book* LibrarySystem::findBook(int id) {
+    return books.find(id);
+}
+
+void LibrarySystem::displayAllBooks(SortOrder order) const {
+    if (books.empty()) {
+        std::cout << "图书馆中没有图书！" << std::endl;
+        return;
+    }
+    
+    std::cout << "图书馆中共有 " << books.size() << " 本图书：" << std::endl;
+    std::cout << "=======================================" << std::endl;
+    
+    if (order == ORDER_BY_ID) {
+        for (const Book& book : books) {
+            book.display();
+            std::cout << "=======================================" << std::endl;
+        }
+        return;
+    }
+    
+    // 沿排序视图顺序输出，不需要排序
+    buildSortedViews();
+    bookViews[order - ORDER_BY_NAME].forEach([this](int id) {
+        books.find(id)->display();
+        std::cout << "=======================================" << std::endl;
+    });
+}
+
+// 按排序方式的第page页（从0开始）。按名称排序时在跳表中按名次定位，开销为O(log n + 页长)；
+// 按ID时沿存活位图跳过前面各页
+std::vector<Book*> LibrarySystem::sortedBooksPage(SortOrder order, size_t page, size_t pageSize) const {
+    std::vector<Book*> results;
+    std::vector<int> ids;
+    if (order == ORDER_BY_ID) {
+        const BitSet& live = books.getLive();
+        size_t skip = page * pageSize;
+        for (size_t id = live.nextSet(0); id < live.size() && ids.size() < pageSize; id = live.nextSet(id + 1)) {
+            if (skip > 0) {
+                --skip;
+            } else {
+                ids.push_back(static_cast<int>(id));
+            }
+        }
+    } else {
+        buildSortedViews();
+        bookViews[order - ORDER_BY_NAME].range(page * pageSize, pageSize, ids);
+    }
+    
+    for (int id : ids) {
+        results.push_back(const_cast<Book*>(books.find(id)));
+    }
+    return results;
+}
+
+Title* LibrarySystem::findTitle(int id) {
+    if (id <= 0 || id >= static_cast<int>(titles.size())) {
+        return nullptr;
+    }
+    return titles[id].get();
+}
+
+std::vector<Title*> LibrarySystem::searchTitles(const std::string& keyword) const {
+    std::vector<Title*> results;
+    
+    // 同一书目的各册只比较一次；书目文本已规范化并连续存放，整块扫描
+    for (int titleId : titleText.search(foldText(keyword))) {
+        results.push_back(titles[titleId].get());
+    }
+    
+    return results;
+}
+
+// 条件查询：每个文本条件先在书目文本区中整块扫描一次（不限字段时直接用缓存的查找结果），
+// 求成按图书ID索引的位图；必须成立的条件（文本条件、借出位图、ID）取交集作为候选，
+// 没有这样的条件时以全部图书为候选；再对候选按64本一批把各条件的位图按程序组合
+bool LibrarySystem::queryBooks(const std::string& query, std::vector<Book*>& results) const {
+    results.clear();
+    QueryProgram program;
+    std::string error;
+    if (!program.compile(query, QueryProgram::QUERY_BOOKS, error)) {
+        std::cout << "查询有误：" << error << std::endl;
+        return false;
+    }
+    
+    const std::vector<QueryProgram::Instruction>& code = program.getCode();
+    BitSet candidates = books.getLive();
+    std::ostringstream plan;
+    std::vector<BitSet> matches(code.size());   // 按指令下标，文本条件的位图
+    for (size_t index = 0; index < code.size(); ++index) {
+        const QueryProgram::Instruction& instruction = code[index];
+        if (instruction.op != QueryProgram::OP_MATCH) {
+            continue;
+        }
+        const std::string& keyword = program.getConstant(instruction.operand);
+        BitSet& matched = matches[index];
+        matched = BitSet(candidates.size());
+        if (instruction.field == QueryProgram::FIELD_ALL) {
+            for (int id : matchBooks(keyword, FILTER_ANY)) {
+                matched.set(id);
+            }
+        } else {
+            // 书目文本区中各字段依次为书名、作者、出版社
+            for (int titleId : titleText.search(keyword, instruction.field - QueryProgram::FIELD_NAME)) {
+                for (int bookId : titles[titleId]->getCopyIds()) {
+                    matched.set(bookId);
+                }
+            }
+        }
+        plan << "  文本区扫描：#" << index << " " << QueryProgram::fieldName(instruction.field) 
+             << " \"" << keyword << "\"，" << matched.count() << " 册\n";
+    }
+    
+    for (size_t index : program.getConjuncts()) {
+        const QueryProgram::Instruction& instruction = code[index];
+        if (instruction.op == QueryProgram::OP_MATCH) {
+            candidates &= matches[index];
+            plan << "  候选求交：#" << index << "\n";
+        } else if (instruction.op == QueryProgram::OP_AVAILABLE) {
+            candidates.andNot(borrowedBits);
+            plan << "  位图：去掉已借出的图书\n";
+        } else if (instruction.op == QueryProgram::OP_BORROWED) {
+            candidates &= borrowedBits;
+            plan << "  位图：只留已借出的图书\n";
+        } else if (instruction.op == QueryProgram::OP_ID) {
+            BitSet one(candidates.size());
+            if (books.find(instruction.operand)) {
+                one.set(instruction.operand);
+            }
+            candidates &= one;
+            plan << "  直接定位：ID " << instruction.operand << "\n";
+        }
+    }
+    if (program.getConjuncts().empty()) {
+        plan << "  全部 " << books.size() << " 册为候选\n";
+    }
+    
+    std::vector<int> ids;
+    size_t candidateCount = candidates.count();
+    size_t batches = runProgram(program, candidates,
+        [this, &code, &matches](const QueryProgram::Instruction& instruction, std::uint64_t lanes, size_t w) {
+            switch (instruction.op) {
+                case QueryProgram::OP_AVAILABLE:
+                    return lanes & ~borrowedBits.word(w);
+                case QueryProgram::OP_BORROWED:
+                    return lanes & borrowedBits.word(w);
+                case QueryProgram::OP_ID:
+                    return lanes & idLane(instruction.operand, w);
+                default:
+                    return lanes & matches[&instruction - code.data()].word(w);
+            }
+        }, ids);
+    
+    for (int id : ids) {
+        results.push_back(const_cast<Book*>(books.find(id)));
+    }
+    
+    if (program.isExplain()) {
+        std::cout << "谓词程序：\n" << program.disassemble();
+        std::cout << "执行计划：\n" << plan.str();
+        std::cout << "候选 " << candidateCount << " 册，分 " << batches << " 批求值，结果 " 
+                  << results.size() << " 册" << std::endl;
+    }
+    return true;
+}
+
+// 按BM25相关度取前k种，书名中命中的权重最高
+std::vector<std::pair<Title*, double>> LibrarySystem::rankTitles(const std::string& keyword, size_t k) const {
+    std::vector<std::pair<Title*, double>> results;
+    buildSearchIndexes();
+    for (const auto& entry : titleTerms.topK(keyword, k)) {
+        results.emplace_back(titles[entry.first].get(), entry.second);
+    }
+    return results;
+}
+
+// 拼音查找：书名或作者的全拼、拼音首字母以输入开头即匹配，如“lx”“luxun”都能找到鲁迅的书
+std::vector<Title*> LibrarySystem::searchTitlesByPinyin(const std::string& query) const {
+    std::vector<Title*> results;
+    buildSearchIndexes();
+    for (int id : titlePinyin.search(query)) {
+        results.push_back(titles[id].get());
+    }
+    return results;
+}
+
+// 多关键字查找：关键字以空格分隔，每个关键字按相关度索引的切词规则切成词项，
+// 书目的书名、作者、出版社中含有关键字的全部词项即算包含该关键字。
+// matchAll为true时要求包含所有关键字，直接把所有词项的倒排表一起求交；
+// 否则每个关键字求交后再把各关键字的结果求并
+bool LibrarySystem::searchTitlesByWords(const std::string& words, bool matchAll, 
+                                        std::vector<Title*>& results) const {
+    results.clear();
+    std::vector<std::vector<const std::vector<int>*>> keywords;   // 每个关键字各词项的倒排表
+    std::vector<std::string> terms;
+    std::istringstream input(foldText(words));
+    std::string keyword;
+    bool missing = false;   // 有词项不在索引中
+    buildSearchIndexes();
+    while (input >> keyword) {
+        terms.clear();
+        Bm25Index::tokenize(keyword, terms);
+        if (terms.empty()) {
+            continue;
+        }
+        keywords.emplace_back();
+        for (const std::string& term : terms) {
+            const std::vector<int>* list = titleTerms.findPostings(term);
+            if (!list) {
+                missing = true;
+                keywords.pop_back();
+                break;
+            }
+            keywords.back().push_back(list);
+        }
+    }
+    if (keywords.empty() && !missing) {
+        std::cout << "请输入至少一个关键字！" << std::endl;
+        return false;
+    }
+    
+    std::vector<int> ids;
+    if (matchAll) {
+        if (missing) {
+            return true;
+        }
+        std::vector<const std::vector<int>*> lists;
+        for (const auto& keywordLists : keywords) {
+            lists.insert(lists.end(), keywordLists.begin(), keywordLists.end());
+        }
+        intersectPostings(lists, ids);
+    } else {
+        std::vector<std::vector<int>> matches(keywords.size());
+        std::vector<const std::vector<int>*> lists;
+        for (size_t i = 0; i < keywords.size(); ++i) {
+            if (keywords[i].size() == 1) {
+                lists.push_back(keywords[i][0]);
+            } else {
+                intersectPostings(keywords[i], matches[i]);
+                lists.push_back(&matches[i]);
+            }
+        }
+        unionPostings(lists, ids);
+    }
+    
+    for (int id : ids) {
+        results.push_back(titles[id].get());
+    }
+    return true;
+}
+
+// 容错查找：书名、作者、出版社任一字段中有与关键字至多maxErrors处差异的片段即匹配，
+// 差异少的排在前面
+bool LibrarySystem::fuzzySearchTitles(const std::string& keyword, int maxErrors,
+                                      std::vector<std::pair<Title*, int>>& results) const {
+    results.clear();
+    std::vector<std::pair<int, int>> matches;
+    buildSearchIndexes();
+    if (!titleFuzzy.search(keyword, maxErrors, matches)) {
+        std::cout << "关键字不能为空，也不能超过 " << BitParallelMatcher::MAX_LENGTH << " 个字！" << std::endl;
+        return false;
+    }
+    
+    for (const auto& match : matches) {
+        results.emplace_back(titles[match.first].get(), match.second);
+    }
+    return true;
+}
+
+// 输入前缀时的联想：只沿前缀路径和次数最多的分支展开，与书目总数无关
+std::vector<std::pair<std::string, int>> LibrarySystem::suggestTitles(const std::string& prefix, size_t k) const {
+    return titleNames.complete(prefix, k);
+}
+
+std::vector<std::pair<std::string, int>> LibrarySystem::suggestAuthors(const std::string& prefix, size_t k) const {
+    return authorNames.complete(prefix, k);
+}
+
+// 匹配的图书ID，按ID升序。结果按（规范化后的关键字，借阅状态）缓存：先查缓存，未命中时把
+// 匹配书目的各册在按图书ID索引的位图中置1，再与借出位图逐字运算，结果存入缓存。
+// 返回的引用指向缓存项或内部缓冲区，只在下次查找前有效，需要保留时应复制
+const std::vector<int>& LibrarySystem::matchBooks(const std::string& keyword, AvailabilityFilter filter) const {
+    std::string folded = foldText(keyword);
+    const std::vector<int>* cached = queryCache.find(folded, filter);
+    if (cached) {
+        return *cached;
+    }
+    
+    BitSet matched(books.getLive().size());
+    std::vector<int> titleIds = titleText.search(folded);
+    for (int titleId : titleIds) {
+        for (int bookId : titles[titleId]->getCopyIds()) {
+            matched.set(bookId);
+        }
+    }
+    
+    if (filter == FILTER_AVAILABLE) {
+        matched.andNot(borrowedBits);
+    } else if (filter == FILTER_BORROWED) {
+        matched &= borrowedBits;
+    }
+    
+    matchBuffer.clear();
+    matchBuffer.reserve(matched.count());
+    matched.forEachSet([this](size_t id) {
+        matchBuffer.push_back(static_cast<int>(id));
+    });
+    queryCache.insert(folded, filter, matchBuffer, titleIds);
+    return matchBuffer;
+}
+
+std::vector<Book*> LibrarySystem::searchBooks(const std::string& keyword, AvailabilityFilter filter) const {
+    const std::vector<int>& ids = matchBooks(keyword, filter);
+    
+    std::vector<Book*> results;
+    results.reserve(ids.size());
+    for (int id : ids) {
+        // 使用const_cast来处理const容器中的非const元素
+        results.push_back(const_cast<Book*>(books.find(id)));
+    }
+    return results;
+}
+
+// 在一次查找得到的结果（按ID升序）中分页，每页只取出pageSize本，不为全部匹配的图书分配指针；
+// 翻页不再重新查找，一次用户查询只计入一次缓存命中率。两页之间被删除的图书跳过
+std::vector<Book*> LibrarySystem::searchBooksPage(const std::vector<int>& matches, SearchCursor& cursor,
+                                                  size_t pageSize) const {
+    std::vector<Book*> page;
+    if (cursor.done) {
+        return page;
+    }
+    
+    auto it = std::upper_bound(matches.begin(), matches.end(), cursor.after);
+    for (; it != matches.end() && page.size() < pageSize; ++it) {
+        const Book* book = books.find(*it);
+        if (book) {
+            page.push_back(const_cast<Book*>(book));
+        }
+        cursor.after = *it;
+    }
+    cursor.done = it == matches.end();
+    return page;
+}
+
+size_t LibrarySystem::availableBookCount() const {
+    return books.size() - borrowedBookCount();
+}
+
+size_t LibrarySystem::borrowedBookCount() const {
+    // 已删除的图书在detachTitle时清除了借出位，这里不必再与存活位求交
+    return borrowedBits.count();
+}
+
+bool LibrarySystem::addReader(const std::string& name, const std::string& contact) {
+    Reader* reader = readers.insert(Reader(readerIds.allocate(std::time(nullptr)), name, contact));
+    if (!reader) {
+        std::cout << "分配的读者ID已被占用，添加失败！" << std::endl;
+        saveIds();
+        return false;
+    }
+    readerNames.insert(name);
+    if (searchIndexesReady) {
+        readerPinyin.add(reader->getId(), {&reader->getName()});
+    }
+    if (sortedViewsReady) {
+        std::string key;
+        collationKey(name, key);
+        readerView.insert(key, reader->getId());
+    }
+    saveIds();
+    saveReaders();
+    return true;
+}
+
+bool LibrarySystem::removeReader(int id) {
+    Reader* reader = readers.find(id);
+    if (!reader) {
+        return false;
+    }
+    
+    // 检查读者是否有未归还的图书
+    if (!reader->getBorrowedBooks().empty()) {
+        std::cout << "该读者有未归还的图书，无法删除！" << std::endl;
+        return false;
+    }
+    
+    readerNames.remove(reader->getName());
+    if (searchIndexesReady) {
+        readerPinyin.remove(id);
+    }
+    if (sortedViewsReady) {
+        std::string key;
+        collationKey(reader->getName(), key);
+        readerView.erase(key, id);
+    }
+    readers.erase(id);
+    holds.dropReader(id);
+    saveReaders();
+    if (!history.hasReaderHistory(id)) {
+        readerIds.release(id, std::time(nullptr));
+    }
+    saveIds();
+    return true;
+}
+
+Reader* LibrarySystem::findReader(int id) {
+    return readers.find(id);
+}
+
+bool LibrarySystem::setLoanLimit(int readerId, int limit) {
+    Reader* reader = findReader(readerId);
+    if (!reader) {
+        std::cout << "读者ID不存在！" << std::endl;
+        return false;
+    }
+    
+    if (!reader->setLoanLimit(limit)) {
+        std::cout << "借阅上限必须是正整数！" << std::endl;
+        return false;
+    }
+    
+    // 已借数量超过新上限时不强制归还，只是在还到上限以下之前不能再借
+    saveReaders();
+    return true;
+}
+
+void LibrarySystem::displayAllReaders(SortOrder order) const {
+    if (readers.empty()) {
+        std::cout << "图书馆中没有读者！" << std::endl;
+        return;
+    }
+    
+    std::cout << "图书馆中共有 " << readers.size() << " 位读者：" << std::endl;
+    std::cout << "=======================================" << std::endl;
+    
+    if (order != ORDER_BY_NAME) {
+        for (const Reader& reader : readers) {
+            reader.display();
+            std::cout << "=======================================" << std::endl;
+        }
+        return;
+    }
+    
+    buildSortedViews();
+    readerView.forEach([this](int id) {
+        readers.find(id)->display();
+        std::cout << "=======================================" << std::endl;
+    });
+}
+
+std::vector<Reader*> LibrarySystem::sortedReadersPage(SortOrder order, size_t page, size_t pageSize) const {
+    std::vector<Reader*> results;
+    std::vector<int> ids;
+    if (order != ORDER_BY_NAME) {
+        const BitSet& live = readers.getLive();
+        size_t skip = page * pageSize;
+        for (size_t id = live.nextSet(0); id < live.size() && ids.size() < pageSize; id = live.nextSet(id + 1)) {
+            if (skip > 0) {
+                --skip;
+            } else {
+                ids.push_back(static_cast<int>(id));
+            }
+        }
+    } else {
+        buildSortedViews();
+        readerView.range(page * pageSize, pageSize, ids);
+    }
+    
+    for (int id : ids) {
+        results.push_back(const_cast<Reader*>(readers.find(id)));
+    }
+    return results;
+}
+
+std::vector<Reader*> LibrarySystem::searchReaders(const std::string& keyword) const {
+    std::vector<Reader*> results;
+    std::string lowerKeyword = foldText(keyword);
+    
+    std::string name, contact;
+    for (const Reader& reader : readers) {
+        if (readerMatches(reader, lowerKeyword, name, contact)) {
+            // 使用const_cast来处理const vector中的非const元素
+            results.push_back(const_cast<Reader*>(&reader));
+        }
+    }
+    
+    return results;
+}
+
+// 从上一页停下的ID继续扫描，凑满一页就停止，后面的读者留到下一页再比较
+std::vector<Reader*> LibrarySystem::searchReadersPage(const std::string& keyword, SearchCursor& cursor, 
+                                                      size_t pageSize) const {
+    std::vector<Reader*> page;
+    if (cursor.done) {
+        return page;
+    }
+    
+    std::string lowerKeyword = foldText(keyword);
+    std::string name, contact;
+    const BitSet& live = readers.getLive();
+    size_t id = live.nextSet(static_cast<size_t>(cursor.after) + 1);
+    while (id < live.size() && page.size() < pageSize) {
+        const Reader* reader = readers.find(static_cast<int>(id));
+        if (readerMatches(*reader, lowerKeyword, name, contact)) {
+            page.push_back(const_cast<Reader*>(reader));
+        }
+        cursor.after = static_cast<int>(id);
+        id = live.nextSet(id + 1);
+    }
+    cursor.done = id >= live.size();
+    return page;
+}
+
+std::vector<Reader*> LibrarySystem::searchReadersByPinyin(const std::string& query) const {
+    std::vector<Reader*> results;
+    buildSearchIndexes();
+    for (int id : readerPinyin.search(query)) {
+        results.push_back(const_cast<Reader*>(readers.find(id)));
+    }
+    return results;
+}
+
+// 读者没有文本索引：只有ID条件能直接定位，其余情况扫描全部读者。
+// 扫描时每位读者的姓名和联系方式只规范化一次，同时求出所有文本条件的位图
+bool LibrarySystem::queryReaders(const std::string& query, std::vector<Reader*>& results) const {
+    results.clear();
+    QueryProgram program;
+    std::string error;
+    if (!program.compile(query, QueryProgram::QUERY_READERS, error)) {
+        std::cout << "查询有误：" << error << std::endl;
+        return false;
+    }
+    
+    const std::vector<QueryProgram::Instruction>& code = program.getCode();
+    BitSet candidates = readers.getLive();
+    std::ostringstream plan;
+    bool located = false;
+    for (size_t index : program.getConjuncts()) {
+        const QueryProgram::Instruction& instruction = code[index];
+        if (instruction.op == QueryProgram::OP_ID) {
+            BitSet one(candidates.size());
+            if (readers.find(instruction.operand)) {
+                one.set(instruction.operand);
+            }
+            candidates &= one;
+            plan << "  直接定位：ID " << instruction.operand << "\n";
+            located = true;
+        }
+    }
+    
+    std::vector<size_t> leaves;                 // 文本条件的指令下标
+    std::vector<BitSet> matches(code.size());   // 按指令下标，文本条件的位图
+    for (size_t index = 0; index < code.size(); ++index) {
+        if (code[index].op == QueryProgram::OP_MATCH) {
+            leaves.push_back(index);
+            matches[index] = BitSet(candidates.size());
+        }
+    }
+    if (!leaves.empty()) {
+        std::string name;
+        std::string contact;
+        for (size_t id = candidates.nextSet(0); id < candidates.size(); id = candidates.nextSet(id + 1)) {
+            const Reader* reader = readers.find(static_cast<int>(id));
+            foldText(reader->getName(), name);
+            foldText(reader->getContact(), contact);
+            for (size_t index : leaves) {
+                const std::string& keyword = program.getConstant(code[index].operand);
+                QueryProgram::Field field = code[index].field;
+                if ((field != QueryProgram::FIELD_CONTACT && name.find(keyword) != std::string::npos) ||
+                    (field != QueryProgram::FIELD_NAME && contact.find(keyword) != std::string::npos)) {
+                    matches[index].set(id);
+                }
+            }
+        }
+        plan << "  " << (located ? "候选" : "全表") << "扫描：" << candidates.count() << " 位读者，求出 " 
+             << leaves.size() << " 个文本条件（读者没有文本索引）\n";
+    }
+    
+    std::vector<int> ids;
+    size_t candidateCount = candidates.count();
+    size_t batches = runProgram(program, candidates,
+        [&code, &matches](const QueryProgram::Instruction& instruction, std::uint64_t lanes, size_t w) {
+            if (instruction.op == QueryProgram::OP_ID) {
+                return lanes & idLane(instruction.operand, w);
+            }
+            return lanes & matches[&instruction - code.data()].word(w);
+        }, ids);
+    
+    for (int id : ids) {
+        results.push_back(const_cast<Reader*>(readers.find(id)));
+    }
+    
+    if (program.isExplain()) {
+        std::cout << "谓词程序：\n" << program.disassemble();
+        std::cout << "执行计划：\n" << plan.str();
+        std::cout << "候选 " << candidateCount << " 位，分 " << batches << " 批求值，结果 " 
+                  << results.size() << " 位" << std::endl;
+    }
+    return true;
+}
+
+std::vector<std::pair<std::string, int>> LibrarySystem::suggestReaders(const std::string& prefix, size_t k) const {
+    return readerNames.complete(prefix, k);
+}
+
+// 图书的借阅状态、书目的可借册数和借出位图一起更新
+void LibrarySystem::setBorrowed(Book& book, bool status) {
+    if (book.isBorrowed() != status) {
+        authorFacets.setBorrowed(book.getTitle()->getId(), status);
+        publisherFacets.setBorrowed(book.getTitle()->getId(), status);
+    }
+    book.setBorrowed(status);
+    borrowedBits.assign(book.getId(), status);
+    // 只影响按借阅状态筛选、且包含这一书目的缓存结果
+    queryCache.invalidateTitle(book.getTitle()->getId(), true);
+}
+
+// 借出图书并登记借阅记录，返回应还时间；读者已借此书或已达到借阅上限时返回0
+std::time_t LibrarySystem::lendBook(Reader& reader, Book& book) {
+    if (!reader.borrowBook(book.getId())) {
+        return 0;
+    }
+    setBorrowed(book, true);
+    
+    std::time_t now = std::time(nullptr);
+    std::time_t due = now + LoanSchedule::DEFAULT_LOAN_DAYS * 24 * 3600;
+    loans.add({book.getId(), reader.getId(), now, due, false});
+    history.append(EVENT_BORROW, book.getId(), reader.getId(), now);
+    recordPopularity(book.getTitle()->getId(), reader.getId(), now);
+    coBorrows.recordBorrow(reader.getId(), book.getTitle()->getId());
+    return due;
+}
+
+// 图书归还后直接借给该书目预约队列中的下一位读者
+void LibrarySystem::handOffToHolder(Book& book) {
+    while (true) {
+        int readerId = holds.popNext(book.getTitle()->getId());
+        if (readerId == 0) {
+            return;
+        }
+        
+        Reader* reader = findReader(readerId);
+        if (!reader) {
+            continue;
+        }
+        if (!reader->canBorrow()) {
+            std::cout << "预约读者 " << reader->getName() << "（ID: " << readerId 
+                      << "）已达到借阅上限，顺延给下一位。" << std::endl;
+            continue;
+        }
+        
+        std::time_t due = lendBook(*reader, book);
+        if (due != 0) {
+            std::cout << "该图书已自动借给预约读者 " << reader->getName() << "（ID: " << readerId 
+                      << "），应还日期：" << formatDate(due) << std::endl;
+            return;
+        }
+    }
+}
+
+bool LibrarySystem::borrowBook(int readerId, int bookId) {
+    Reader* reader = findReader(readerId);
+    if (!reader) {
+        std::cout << "读者ID不存在！" << std::endl;
+        return false;
+    }
+    
+    Book* book = findBook(bookId);
+    if (!book) {
+        std::cout << "图书ID不存在！" << std::endl;
+        return false;
+    }
+    
+    if (book->isBorrowed()) {
+        std::cout << "该图书已被借出！可以预约该图书，归还后将自动借给您。" << std::endl;
+        return false;
+    }
+    
+    if (!reader->canBorrow()) {
+        std::cout << "该读者已达到借阅上限（" << reader->getLoanLimit() << " 本），请先归还图书！" << std::endl;
+        return false;
+    }
+    
+    std::time_t due = lendBook(*reader, *book);
+    if (due != 0) {
+        saveBooks();
+        saveReaders();
+        saveLoans();
+        std::cout << "借书成功！应还日期：" << formatDate(due) << std::endl;
+        return true;
+    }
+    
+    std::cout << "借书失败，可能是已经借了该书！" << std::endl;
+    return false;
+}
+
+bool LibrarySystem::returnBook(int readerId, int bookId) {
+    Reader* reader = findReader(readerId);
+    if (!reader) {
+        std::cout << "读者ID不存在！" << std::endl;
+        return false;
+    }
+    
+    Book* book = findBook(bookId);
+    if (!book) {
+        std::cout << "图书ID不存在！" << std::endl;
+        return false;
+    }
+    
+    if (!book->isBorrowed()) {
+        std::cout << "该图书未被借出！" << std::endl;
+        return false;
+    }
+    
+    if (reader->returnBook(bookId)) {
+        setBorrowed(*book, false);
+        
+        const Loan* loan = loans.find(bookId);
+        std::time_t now = std::time(nullptr);
+        if (loan && loan->dueTime < now) {
+            long long days = std::max<long long>(1, (now - loan->dueTime) / (24 * 3600));
+            std::cout << "该图书已逾期 " << days << " 天。" << std::endl;
+        }
+        loans.remove(bookId);
+        history.append(EVENT_RETURN, bookId, readerId, now);
+        std::cout << "还书成功！" << std::endl;
+        
+        handOffToHolder(*book);
+        
+        saveBooks();
+        saveReaders();
+        saveLoans();
+        return true;
+    }
+    
+    std::cout << "还书失败，可能是没有借这本书！" << std::endl;
+    return false;
+}
+
+bool LibrarySystem::reserveBook(int readerId, int bookId) {
+    Reader* reader = findReader(readerId);
+    if (!reader) {
+        std::cout << "读者ID不存在！" << std::endl;
+        return false;
+    }
+    
+    Book* book = findBook(bookId);
+    if (!book) {
+        std::cout << "图书ID不存在！" << std::endl;
+        return false;
+    }
+    
+    // 预约的是书目，任一册归还都会交给队首读者
+    const Title& title = *book->getTitle();
+    if (title.hasAvailableCopy()) {
+        std::cout << "该书还有可借的副本，可以直接借阅，无需预约！" << std::endl;
+        return false;
+    }
+    
+    for (int borrowedId : reader->getBorrowedBooks()) {
+        const Book* borrowed = findBook(borrowedId);
+        if (borrowed && borrowed->getTitle()->getId() == title.getId()) {
+            std::cout << "该读者已经借了这本书！" << std::endl;
+            return false;
+        }
+    }
+    
+    if (!holds.reserve(title.getId(), bookId, readerId)) {
+        std::cout << "该读者已经预约了这本书！" << std::endl;
+        return false;
+    }
+    
+    std::cout << "预约成功！当前排在第 " << holds.positionOf(title.getId(), readerId) << " 位。" << std::endl;
+    return true;
+}
+
+// bookId可以是该书目的任一册
+bool LibrarySystem::cancelReservation(int readerId, int bookId) {
+    const Book* book = findBook(bookId);
+    if (!book || !holds.cancel(book->getTitle()->getId(), readerId)) {
+        std::cout << "没有找到该预约！" << std::endl;
+        return false;
+    }
+    
+    std::cout << "已取消预约。" << std::endl;
+    return true;
+}
+
+void LibrarySystem::displayReservations(int readerId) const {
+    std::vector<int> titleIds = holds.reservationsOf(readerId);
+    if (titleIds.empty()) {
+        std::cout << "该读者没有预约任何图书！" << std::endl;
+        return;
+    }
+    
+    std::sort(titleIds.begin(), titleIds.end());
+    std::cout << "该读者预约了 " << titleIds.size() << " 种图书：" << std::endl;
+    for (int titleId : titleIds) {
+        if (titleId <= 0 || titleId >= static_cast<int>(titles.size()) || !titles[titleId]) {
+            std::cout << "预约的图书已被删除（书目ID: " << titleId << "）" << std::endl;
+            continue;
+        }
+        const Title& title = *titles[titleId];
+        std::cout << "《" << title.getName() << "》 " << title.getAuthor() << "（图书ID: ";
+        const std::vector<int>& copyIds = title.getCopyIds();
+        for (size_t i = 0; i < copyIds.size(); ++i) {
+            std::cout << (i == 0 ? "" : "、") << copyIds[i];
+        }
+        std::cout << "），排在第 " << holds.positionOf(titleId, readerId) << " 位，共 " 
+                  << holds.queueLength(titleId) << " 人排队" << std::endl;
+    }
+}
+
+void LibrarySystem::displayHistoryEvent(const HistoryEvent& event) const {
+    const Book* book = findBook(event.bookId);
+    const Reader* reader = findReader(event.readerId);
+    
+    std::cout << formatDate(static_cast<std::time_t>(event.time)) << "  "
+              << (event.type == EVENT_BORROW ? "借出" : "归还") << "  图书ID: " << event.bookId;
+    if (book) {
+        std::cout << "（" << book->getName() << "）";
+    }
+    std::cout << "  读者ID: " << event.readerId;
+    if (reader) {
+        std::cout << "（" << reader->getName() << "）";
+    }
+    std::cout << std::endl;
+}
+
+void LibrarySystem::displayBookHistory(int bookId) const {
+    std::vector<HistoryEvent> events = history.bookHistory(bookId);
+    if (events.empty()) {
+        std::cout << "该图书没有借阅历史！" << std::endl;
+        return;
+    }
+    
+    std::cout << "该图书共有 " << events.size() << " 条借还记录：" << std::endl;
+    for (const HistoryEvent& event : events) {
+        displayHistoryEvent(event);
+    }
+}
+
+void LibrarySystem::displayReaderHistory(int readerId) const {
+    std::vector<HistoryEvent> events = history.readerHistory(readerId);
+    if (events.empty()) {
+        std::cout << "该读者没有借阅历史！" << std::endl;
+        return;
+    }
+    
+    std::cout << "该读者共有 " << events.size() << " 条借还记录：" << std::endl;
+    for (const HistoryEvent& event : events) {
+        displayHistoryEvent(event);
+    }
+}
+
+void LibrarySystem::displayHistoryBetween(std::time_t from, std::time_t to) const {
+    size_t count = 0;
+    history.forEachBetween(from, to, [this, &count](const HistoryEvent& event) {
+        displayHistoryEvent(event);
+        ++count;
+    });
+    
+    if (count == 0) {
+        std::cout << "该时间段内没有借还记录！" << std::endl;
+    } else {
+        std::cout << "共 " << count << " 条借还记录。" << std::endl;
     }
-    return -1;
 }
 
-int LibrarySystem::findReaderIndex(int id) const {
-    for (size_t i = 0; i < readers.size(); ++i) {
-        if (readers[i].getId() == id) {
-            return i;
-        }
+// 本周一零点（本地时间）
+std::time_t LibrarySystem::weekStart(std::time_t time) {
+    std::tm local = *std::localtime(&time);
+    local.tm_mday -= (local.tm_wday + 6) % 7;
+    local.tm_hour = 0;
+    local.tm_min = 0;
+    local.tm_sec = 0;
+    local.tm_isdst = -1;
+    return std::mktime(&local);
+}
+
+void LibrarySystem::recordPopularity(int titleId, int readerId, std::time_t time) {
+    // 进入新的一周时清空统计
+    if (time >= statsWindowStart + 7 * 24 * 3600) {
+        popularTitles.clear();
+        activeReaders.clear();
+        statsWindowStart = weekStart(time);
     }
-    return -1;
+    popularTitles.add(titleId);
+    activeReaders.add(readerId);
 }
 
-bool LibrarySystem::addBook(const std::string& name, const std::string& author, const std::string& publisher) {
-    Book book(nextBookId++, name, author, publisher);
-    books.push_back(book);
-    saveBooks();
-    return true;
+// 启动时用本周的借还历史恢复统计（书目ID每次启动重新分配，不能持久化）
+void LibrarySystem::rebuildPopularity() {
+    std::time_t now = std::time(nullptr);
+    popularTitles.clear();
+    activeReaders.clear();
+    statsWindowStart = weekStart(now);
+    
+    std::unordered_map<int, int> titleOf;
+    for (const Book& book : books) {
+        titleOf[book.getId()] = book.getTitle()->getId();
+    }
+    
+    history.forEachBetween(statsWindowStart, now, [this, &titleOf](const HistoryEvent& event) {
+        if (event.type != EVENT_BORROW) {
+            return;
+        }
+        auto it = titleOf.find(event.bookId);
+        if (it != titleOf.end()) {
+            popularTitles.add(it->second);
+        }
+        activeReaders.add(event.readerId);
+    });
 }
 
-bool LibrarySystem::removeBook(int id) {
-    int index = findBookIndex(id);
-    if (index == -1) {
-        return false;
+// 启动时用最近一年的借阅历史恢复推荐关系，读者手上的在借图书先记入各自的最近借阅
+void LibrarySystem::rebuildRecommendations() {
+    std::time_t now = std::time(nullptr);
+    coBorrows.clear();
+    
+    std::unordered_map<int, int> titleOf;
+    for (const Book& book : books) {
+        titleOf[book.getId()] = book.getTitle()->getId();
     }
     
-    // 检查是否有读者借了这本书
     for (const Reader& reader : readers) {
-        const std::vector<int>& borrowedBooks = reader.getBorrowedBooks();
-        if (std::find(borrowedBooks.begin(), borrowedBooks.end(), id) != borrowedBooks.end()) {
-            std::cout << "该书已被借出，无法删除！" << std::endl;
-            return false;
+        for (int bookId : reader.getBorrowedBooks()) {
+            auto it = titleOf.find(bookId);
+            if (it != titleOf.end()) {
+                coBorrows.rememberBorrow(reader.getId(), it->second);
+            }
         }
     }
     
-    books.erase(books.begin() + index);
-    saveBooks();
-    return true;
+    history.forEachBetween(now - 365 * 24 * 3600, now, [this, &titleOf](const HistoryEvent& event) {
+        if (event.type != EVENT_BORROW) {
+            return;
+        }
+        auto it = titleOf.find(event.bookId);
+        if (it != titleOf.end()) {
+            coBorrows.recordBorrow(event.readerId, it->second);
+        }
+    });
 }
 
-Book* LibrarySystem::findBook(int id) {
-    int index = findBookIndex(id);
-    if (index == -1) {
-        return nullptr;
+void LibrarySystem::displayRecommendations(int titleId) const {
+    const std::vector<std::pair<int, std::uint32_t>>& neighbors = coBorrows.recommend(titleId);
+    bool first = true;
+    for (const auto& entry : neighbors) {
+        if (entry.first <= 0 || entry.first >= static_cast<int>(titles.size()) || !titles[entry.first]) {
+            continue;
+        }
+        std::cout << (first ? "借阅此书的读者也借阅了：" : "、") 
+                  << "《" << titles[entry.first]->getName() << "》";
+        first = false;
+    }
+    if (!first) {
+        std::cout << std::endl;
     }
-    return &books[index];
 }
 
-void LibrarySystem::displayAllBooks() const {
-    if (books.empty()) {
-        std::cout << "图书馆中没有图书！" << std::endl;
+void LibrarySystem::displayTitles(const std::vector<Title*>& results) const {
+    if (results.empty()) {
+        std::cout << "未找到匹配的图书！" << std::endl;
         return;
     }
     
-    std::cout << "图书馆中共有 " << books.size() << " 本图书：" << std::endl;
+    std::cout << "找到 " << results.size() << " 种匹配的图书：" << std::endl;
     std::cout << "=======================================" << std::endl;
-    
-    for (const Book& book : books) {
-        book.display();
+    for (Title* title : results) {
+        title->display();
+        displayRecommendations(title->getId());
         std::cout << "=======================================" << std::endl;
     }
 }
 
-std::vector<Book*> LibrarySystem::searchBooks(const std::string& keyword) const {
-    std::vector<Book*> results;
-    std::string lowerKeyword = keyword;
-    std::transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), ::tolower);
+void LibrarySystem::displayPopularBooks(size_t k) const {
+    std::vector<std::pair<int, std::uint32_t>> top = popularTitles.top(k);
+    if (top.empty()) {
+        std::cout << "本周还没有借阅记录！" << std::endl;
+        return;
+    }
     
-    for (const Book& book : books) {
-        std::string name = book.getName();
-        std::string author = book.getAuthor();
-        std::string publisher = book.getPublisher();
-        
-        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
-        std::transform(author.begin(), author.end(), author.begin(), ::tolower);
-        std::transform(publisher.begin(), publisher.end(), publisher.begin(), ::tolower);
-        
-        if (name.find(lowerKeyword) != std::string::npos ||
-            author.find(lowerKeyword) != std::string::npos ||
-            publisher.find(lowerKeyword) != std::string::npos) {
-            // 使用const_cast来处理const vector中的非const元素
-            results.push_back(const_cast<Book*>(&book));
+    std::cout << "本周借阅最多的图书（估计值）：" << std::endl;
+    int rank = 0;
+    for (const auto& entry : top) {
+        if (entry.first <= 0 || entry.first >= static_cast<int>(titles.size()) || !titles[entry.first]) {
+            continue;
         }
+        const Title& title = *titles[entry.first];
+        std::cout << ++rank << ". 《" << title.getName() << "》 " << title.getAuthor() 
+                  << "  借阅 " << entry.second << " 次" << std::endl;
     }
-    
-    return results;
-}
-
-bool LibrarySystem::addReader(const std::string& name, const std::string& contact) {
-    Reader reader(nextReaderId++, name, contact);
-    readers.push_back(reader);
-    saveReaders();
-    return true;
 }
 
-bool LibrarySystem::removeReader(int id) {
-    int index = findReaderIndex(id);
-    if (index == -1) {
-        return false;
-    }
-    
-    // 检查读者是否有未归还的图书
-    if (!readers[index].getBorrowedBooks().empty()) {
-        std::cout << "该读者有未归还的图书，无法删除！" << std::endl;
-        return false;
+void LibrarySystem::displayActiveReaders(size_t k) const {
+    std::vector<std::pair<int, std::uint32_t>> top = activeReaders.top(k);
+    if (top.empty()) {
+        std::cout << "本周还没有借阅记录！" << std::endl;
+        return;
     }
     
-    readers.erase(readers.begin() + index);
-    saveReaders();
-    return true;
-}
-
-Reader* LibrarySystem::findReader(int id) {
-    int index = findReaderIndex(id);
-    if (index == -1) {
-        return nullptr;
+    std::cout << "本周借阅最多的读者（估计值）：" << std::endl;
+    int rank = 0;
+    for (const auto& entry : top) {
+        const Reader* reader = findReader(entry.first);
+        if (!reader) {
+            continue;
+        }
+        std::cout << ++rank << ". " << reader->getName() << "（ID: " << entry.first 
+                  << "）  借阅 " << entry.second << " 次" << std::endl;
     }
-    return &readers[index];
 }
 
-void LibrarySystem::displayAllReaders() const {
-    if (readers.empty()) {
-        std::cout << "图书馆中没有读者！" << std::endl;
-        return;
+// 从借还历史精确重算本周的借阅次数，检验估计值是否在误差上界之内
+void LibrarySystem::validatePopularity() const {
+    std::unordered_map<int, int> titleOf;
+    for (const Book& book : books) {
+        titleOf[book.getId()] = book.getTitle()->getId();
     }
     
-    std::cout << "图书馆中共有 " << readers.size() << " 位读者：" << std::endl;
-    std::cout << "=======================================" << std::endl;
-    
-    for (const Reader& reader : readers) {
-        reader.display();
-        std::cout << "=======================================" << std::endl;
-    }
-}
-
-std::vector<Reader*> LibrarySystem::searchReaders(const std::string& keyword) const {
-    std::vector<Reader*> results;
-    std::string lowerKeyword = keyword;
-    std::transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), ::tolower);
+    std::unordered_map<int, std::uint32_t> titleCounts;
+    std::unordered_map<int, std::uint32_t> readerCounts;
+    history.forEachBetween(statsWindowStart, std::time(nullptr), 
+                           [&titleOf, &titleCounts, &readerCounts](const HistoryEvent& event) {
+        if (event.type != EVENT_BORROW) {
+            return;
+        }
+        auto it = titleOf.find(event.bookId);
+        if (it != titleOf.end()) {
+            ++titleCounts[it->second];
+        }
+        ++readerCounts[event.readerId];
+    });
     
-    for (const Reader& reader : readers) {
-        std::string name = reader.getName();
-        std::string contact = reader.getContact();
+    const size_t k = 10;
+    auto check = [k](const char* label, const TopKTracker& tracker, 
+                     const std::unordered_map<int, std::uint32_t>& exact) {
+        const CountMinSketch& sketch = tracker.getSketch();
+        std::vector<std::pair<int, std::uint32_t>> estimated = tracker.top(k);
         
-        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
-        std::transform(contact.begin(), contact.end(), contact.begin(), ::tolower);
+        std::uint32_t maxError = 0;
+        for (const auto& entry : estimated) {
+            auto it = exact.find(entry.first);
+            std::uint32_t actual = it != exact.end() ? it->second : 0;
+            maxError = std::max(maxError, entry.second - std::min(entry.second, actual));
+        }
         
-        if (name.find(lowerKeyword) != std::string::npos ||
-            contact.find(lowerKeyword) != std::string::npos) {
-            // 使用const_cast来处理const vector中的非const元素
-            results.push_back(const_cast<Reader*>(&reader));
+        // 精确的Top-K
+        std::vector<std::pair<std::uint32_t, int>> sorted;
+        for (const auto& entry : exact) {
+            sorted.emplace_back(entry.second, entry.first);
         }
-    }
+        size_t n = std::min(k, sorted.size());
+        std::partial_sort(sorted.begin(), sorted.begin() + n, sorted.end(),
+                          [](const std::pair<std::uint32_t, int>& a, const std::pair<std::uint32_t, int>& b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        });
+        size_t overlap = 0;
+        for (size_t i = 0; i < n; ++i) {
+            for (const auto& entry : estimated) {
+                if (entry.first == sorted[i].second) {
+                    ++overlap;
+                    break;
+                }
+            }
+        }
+        
+        std::cout << label << "：共 " << sketch.getTotal() << " 次借阅，Top-" << k 
+                  << " 中最大高估 " << maxError << " 次，理论上界 " << sketch.errorBound()
+                  << " 次（超出概率 " << sketch.failureProbability() << "），与精确Top-" << n 
+                  << " 重合 " << overlap << " 个" << (maxError <= sketch.errorBound() ? "" : "，超出上界！") 
+                  << std::endl;
+    };
     
-    return results;
+    check("图书", popularTitles, titleCounts);
+    check("读者", activeReaders, readerCounts);
 }
 
-bool LibrarySystem::borrowBook(int readerId, int bookId) {
-    Reader* reader = findReader(readerId);
-    if (!reader) {
-        std::cout << "读者ID不存在！" << std::endl;
+bool LibrarySystem::exportJsonLines(const std::string& path) const {
+    JsonLinesWriter writer(path);
+    if (!writer.isOpen()) {
+        std::cout << "无法创建导出文件！" << std::endl;
         return false;
     }
     
-    Book* book = findBook(bookId);
-    if (!book) {
-        std::cout << "图书ID不存在！" << std::endl;
-        return false;
+    for (const Book& book : books) {
+        writer.write(book);
     }
-    
-    if (book->isBorrowed()) {
-        std::cout << "该图书已被借出！" << std::endl;
-        return false;
+    for (const Reader& reader : readers) {
+        writer.write(reader);
     }
     
-    if (reader->borrowBook(bookId)) {
-        book->setBorrowed(true);
-        saveBooks();
-        saveReaders();
-        std::cout << "借书成功！" << std::endl;
-        return true;
+    if (!writer.close()) {
+        std::cout << "写入导出文件失败！" << std::endl;
+        return false;
     }
     
-    std::cout << "借书失败，可能是已经借了该书！" << std::endl;
-    return false;
+    std::cout << "已导出 " << books.size() << " 本图书、" << readers.size() << " 位读者。" << std::endl;
+    return true;
 }
 
-bool LibrarySystem::returnBook(int readerId, int bookId) {
-    Reader* reader = findReader(readerId);
-    if (!reader) {
-        std::cout << "读者ID不存在！" << std::endl;
+bool LibrarySystem::importJsonLines(const std::string& path) {
+    JsonLinesReader jsonReader(path);
+    if (!jsonReader.isOpen()) {
+        std::cout << "导入文件不存在！" << std::endl;
         return false;
     }
     
-    Book* book = findBook(bookId);
-    if (!book) {
-        std::cout << "图书ID不存在！" << std::endl;
-        return false;
+    // 同ID的记录覆盖原记录
+    size_t bookCount = 0;
+    size_t skipped = 0;
+    size_t readerCount = 0;
+    std::vector<int> newCopies;   // 挂到（可能有人预约的）书目下的图书，借阅关系核对后再交给预约读者
+    JsonRecord record;
+    while (jsonReader.next(record)) {
+        const IdAllocator& ids = record.type == "book" ? bookIds : readerIds;
+        if (!DenseTable<Book>::validId(record.id) || record.id - ids.getNextId() > IMPORT_ID_SLACK) {
+            ++skipped;
+            continue;
+        }
+        if (record.type == "book") {
+            Book book(record.id, record.name, record.author, record.publisher);
+            book.setBorrowed(record.borrowed);
+            
+            Book* existing = books.find(record.id);
+            if (existing) {
+                // 换了书目时同removeBook一样更新旧书目的预约队列，日志中不能再用这册代表旧书目
+                std::shared_ptr<Title> oldTitle = existing->getTitle();
+                detachTitle(*existing);
+                *existing = book;
+                attachTitle(*existing);
+                if (existing->getTitle()->getId() != oldTitle->getId()) {
+                    holds.removeCopy(oldTitle->getId(), record.id, 
+                                     oldTitle->getTotalCopies() > 0 ? oldTitle->getCopyIds().front() : 0);
+                    newCopies.push_back(record.id);
+                }
+            } else {
+                attachTitle(*books.insert(book));
+                newCopies.push_back(record.id);
+            }
+            bookIds.reserve(record.id);
+            ++bookCount;
+        } else {
+            Reader reader(record.id, record.name, record.contact);
+            reader.setLoanLimit(record.loanLimit);
+            reader.setBorrowedBooks(record.borrowedBooks);
+            
+            std::string key;
+            Reader* existing = readers.find(record.id);
+            if (existing) {
+                readerNames.remove(existing->getName());
+                if (sortedViewsReady) {
+                    collationKey(existing->getName(), key);
+                    readerView.erase(key, record.id);
+                }
+                *existing = reader;
+            } else {
+                readers.insert(reader);
+            }
+            readerNames.insert(reader.getName());
+            if (searchIndexesReady) {
+                readerPinyin.add(record.id, {&reader.getName()});
+            }
+            if (sortedViewsReady) {
+                collationKey(reader.getName(), key);
+                readerView.insert(key, record.id);
+            }
+            readerIds.reserve(record.id);
+            ++readerCount;
+        }
     }
     
-    if (!book->isBorrowed()) {
-        std::cout << "该图书未被借出！" << std::endl;
-        return false;
+    bool ok = jsonReader.getError().empty();
+    if (!ok) {
+        std::cout << "第 " << jsonReader.getLineNumber() << " 行格式错误：" 
+                  << jsonReader.getError() << "，导入已中止。" << std::endl;
     }
     
-    if (reader->returnBook(bookId)) {
-        book->setBorrowed(false);
+    if (bookCount > 0 || readerCount > 0) {
+        reconcileLoans();
+        syncLoans();
+        // 同addBook：可借的新副本先交给该书目的预约读者
+        for (int bookId : newCopies) {
+            Book* book = books.find(bookId);
+            if (book && !book->isBorrowed() && holds.queueLength(book->getTitle()->getId()) > 0) {
+                handOffToHolder(*book);
+            }
+        }
+        saveIds();
         saveBooks();
         saveReaders();
-        std::cout << "还书成功！" << std::endl;
-        return true;
+        saveLoans();
+    }
+    std::cout << "已导入 " << bookCount << " 本图书、" << readerCount << " 位读者。" << std::endl;
+    if (skipped > 0) {
+        std::cout << "有 " << skipped << " 条记录的ID无效或远超已分配的ID，已跳过。" << std::endl;
+    }
+    return ok;
+}
+
+void LibrarySystem::displayOverdueLoans() const {
+    std::vector<Loan> overdue = loans.overdue(std::time(nullptr));
+    if (overdue.empty()) {
+        std::cout << "没有逾期未还的图书！" << std::endl;
+        return;
     }
     
-    std::cout << "还书失败，可能是没有借这本书！" << std::endl;
-    return false;
+    std::cout << "共有 " << overdue.size() << " 本图书逾期未还：" << std::endl;
+    std::cout << "=======================================" << std::endl;
+    
+    for (const Loan& loan : overdue) {
+        const Book* book = findBook(loan.bookId);
+        const Reader* reader = findReader(loan.readerId);
+        std::cout << "图书ID: " << loan.bookId;
+        if (book) {
+            std::cout << "（" << book->getName() << "）";
+        }
+        std::cout << std::endl;
+        std::cout << "读者ID: " << loan.readerId;
+        if (reader) {
+            std::cout << "（" << reader->getName() << "，" << reader->getContact() << "）";
+        }
+        std::cout << std::endl;
+        std::cout << "借出日期: " << formatDate(loan.borrowTime) << std::endl;
+        std::cout << "应还日期: " << formatDate(loan.dueTime) << std::endl;
+        std::cout << "=======================================" << std::endl;
+    }
+}
+
+void LibrarySystem::sendDueReminders() {
+    size_t count = loans.fireReminders(std::time(nullptr), [this](const Loan& loan) {
+        const Book* book = findBook(loan.bookId);
+        const Reader* reader = findReader(loan.readerId);
+        std::cout << "提醒：读者 " << (reader ? reader->getName() : "?")
+                  << " 借阅的《" << (book ? book->getName() : "?")
+                  << "》已于 " << formatDate(loan.dueTime) << " 到期，请尽快归还。" << std::endl;
+    });
+    
+    if (count == 0) {
+        std::cout << "没有需要提醒的逾期借阅。" << std::endl;
+        return;
+    }
+    saveLoans();
+    std::cout << "已发送 " << count << " 条到期提醒。" << std::endl;
 }
 
 void LibrarySystem::run() {
@@ -347,6 +1974,12 @@ void LibrarySystem::run() {
             case 3:
                 readerManagementMenu();
                 break;
+            case 4:
+                dataMenu();
+                break;
+            case 5:
+                statisticsMenu();
+                break;
             case 0:
                 std::cout << "感谢使用图书管理系统，再见！" << std::endl;
                 return;
@@ -362,6 +1995,8 @@ void LibrarySystem::showMainMenu() const {
     std::cout << "1. 借/还书" << std::endl;
     std::cout << "2. 图书管理" << std::endl;
     std::cout << "3. 读者维护" << std::endl;
+    std::cout << "4. 数据导入/导出" << std::endl;
+    std::cout << "5. 统计信息" << std::endl;
     std::cout << "0. 退出系统" << std::endl;
     std::cout << "================================================" << std::endl;
 }
@@ -373,6 +2008,14 @@ void LibrarySystem::bookManagementMenu() {
         std::cout << "2. 删除图书" << std::endl;
         std::cout << "3. 查找图书" << std::endl;
         std::cout << "4. 显示所有图书" << std::endl;
+        std::cout << "5. 按借阅状态查找图书" << std::endl;
+        std::cout << "6. 书名/作者联想" << std::endl;
+        std::cout << "7. 模糊查找（允许错字）" << std::endl;
+        std::cout << "8. 按相关度查找" << std::endl;
+        std::cout << "9. 条件查询" << std::endl;
+        std::cout << "10. 多关键字查找" << std::endl;
+        std::cout << "11. 拼音/首字母查找" << std::endl;
+        std::cout << "12. 排序分页浏览" << std::endl;
         std::cout << "0. 返回主菜单" << std::endl;
         std::cout << "============================================" << std::endl;
         
@@ -401,49 +2044,274 @@ void LibrarySystem::bookManagementMenu() {
                 std::cout << "请输入出版社: ";
                 std::getline(std::cin, publisher);
                 
-                if (addBook(name, author, publisher)) {
-                    std::cout << "图书添加成功！" << std::endl;
-                } else {
-                    std::cout << "图书添加失败！" << std::endl;
+                int copies;
+                std::cout << "请输入册数: ";
+                std::cin >> copies;
+                
+                if (addBook(name, author, publisher, copies)) {
+                    std::cout << "图书添加成功！" << std::endl;
+                } else {
+                    std::cout << "图书添加失败！" << std::endl;
+                }
+                break;
+            }
+            case 2: {
+                int id;
+                std::cout << "请输入要删除的图书ID: ";
+                std::cin >> id;
+                
+                if (removeBook(id)) {
+                    std::cout << "图书删除成功！" << std::endl;
+                } else {
+                    std::cout << "图书删除失败！" << std::endl;
+                }
+                break;
+            }
+            case 3: {
+                std::string keyword;
+                std::cin.ignore();
+                
+                std::cout << "请输入关键字: ";
+                std::getline(std::cin, keyword);
+                
+                displayTitles(searchTitles(keyword));
+                break;
+            }
+            case 4: {
+                int order;
+                std::cout << "排序方式（0-按ID 1-按书名 2-按作者 3-按出版社）: ";
+                std::cin >> order;
+                if (order < ORDER_BY_ID || order > ORDER_BY_PUBLISHER) {
+                    order = ORDER_BY_ID;
+                }
+                displayAllBooks(static_cast<SortOrder>(order));
+                break;
+            }
+            case 5: {
+                int status;
+                std::string keyword;
+                std::cout << "1. 只看可借  2. 只看已借出  0. 不限" << std::endl;
+                std::cout << "请选择借阅状态: ";
+                std::cin >> status;
+                std::cin.ignore();
+                
+                std::cout << "请输入关键字: ";
+                std::getline(std::cin, keyword);
+                
+                AvailabilityFilter filter = status == 1 ? FILTER_AVAILABLE 
+                                          : status == 2 ? FILTER_BORROWED : FILTER_ANY;
+                // 只查找一次，结果分布和各页都取自这份结果
+                std::vector<int> matches = matchBooks(keyword, filter);
+                displaySearchFacets(matches, 5);
+                // 每次只取一页，看完再取下一页
+                SearchCursor cursor;
+                int pageNumber = 0;
+                while (true) {
+                    std::vector<Book*> page = searchBooksPage(matches, cursor, PAGE_SIZE);
+                    if (page.empty()) {
+                        std::cout << (pageNumber == 0 ? "未找到匹配的图书！" : "没有更多结果了。") << std::endl;
+                        break;
+                    }
+                    
+                    std::cout << "第 " << ++pageNumber << " 页：" << std::endl;
+                    std::cout << "=======================================" << std::endl;
+                    for (Book* book : page) {
+                        book->display();
+                        std::cout << "=======================================" << std::endl;
+                    }
+                    if (cursor.done) {
+                        break;
+                    }
+                    
+                    std::string answer;
+                    std::cout << "按回车显示下一页，输入0返回: ";
+                    if (!std::getline(std::cin, answer) || answer == "0") {
+                        break;
+                    }
+                }
+                break;
+            }
+            case 6: {
+                std::string prefix;
+                std::cin.ignore();
+                
+                std::cout << "请输入书名或作者的开头: ";
+                std::getline(std::cin, prefix);
+                
+                // 书名和作者各取前几个，选中后按该词查找
+                std::vector<std::pair<std::string, int>> names = suggestTitles(prefix, 5);
+                std::vector<std::pair<std::string, int>> authors = suggestAuthors(prefix, 5);
+                if (names.empty() && authors.empty()) {
+                    std::cout << "没有可联想的书名或作者！" << std::endl;
+                    break;
+                }
+                
+                std::vector<std::string> choices;
+                for (const auto& name : names) {
+                    choices.push_back(name.first);
+                    std::cout << choices.size() << ". [书名] " << name.first 
+                              << "（" << name.second << " 种）" << std::endl;
+                }
+                for (const auto& author : authors) {
+                    choices.push_back(author.first);
+                    std::cout << choices.size() << ". [作者] " << author.first 
+                              << "（" << author.second << " 种）" << std::endl;
+                }
+                
+                size_t pick;
+                std::cout << "请选择要查找的词（0 返回）: ";
+                std::cin >> pick;
+                if (std::cin.fail()) {
+                    std::cin.clear();
+                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                    break;
+                }
+                if (pick >= 1 && pick <= choices.size()) {
+                    displayTitles(searchTitles(choices[pick - 1]));
+                }
+                break;
+            }
+            case 7: {
+                std::string keyword;
+                int maxErrors;
+                std::cin.ignore();
+                
+                std::cout << "请输入关键字: ";
+                std::getline(std::cin, keyword);
+                
+                std::cout << "请输入允许的错字数: ";
+                std::cin >> maxErrors;
+                
+                std::vector<std::pair<Title*, int>> results;
+                if (!fuzzySearchTitles(keyword, maxErrors, results)) {
+                    break;
+                }
+                if (results.empty()) {
+                    std::cout << "未找到匹配的图书！" << std::endl;
+                    break;
+                }
+                
+                std::cout << "找到 " << results.size() << " 种匹配的图书：" << std::endl;
+                std::cout << "=======================================" << std::endl;
+                for (const auto& result : results) {
+                    result.first->display();
+                    if (result.second > 0) {
+                        std::cout << "（与关键字相差 " << result.second << " 处）" << std::endl;
+                    }
+                    std::cout << "=======================================" << std::endl;
+                }
+                break;
+            }
+            case 8: {
+                std::string keyword;
+                size_t k;
+                std::cin.ignore();
+                
+                std::cout << "请输入关键字: ";
+                std::getline(std::cin, keyword);
+                
+                std::cout << "请输入显示的条数: ";
+                std::cin >> k;
+                
+                std::vector<std::pair<Title*, double>> results = rankTitles(keyword, k);
+                if (results.empty()) {
+                    std::cout << "未找到匹配的图书！" << std::endl;
+                    break;
+                }
+                
+                std::cout << "相关度最高的 " << results.size() << " 种图书：" << std::endl;
+                std::cout << "=======================================" << std::endl;
+                int rank = 0;
+                for (const auto& result : results) {
+                    std::cout << "第 " << ++rank << " 名（得分 " << result.second << "）" << std::endl;
+                    result.first->display();
+                    std::cout << "=======================================" << std::endl;
+                }
+                break;
+            }
+            case 9: {
+                std::string query;
+                std::cin.ignore();
+                
+                std::cout << "例：author:鲁迅 AND publisher:人民文学 AND available，"
+                          << "前面加 EXPLAIN 显示执行计划" << std::endl;
+                std::cout << "请输入查询条件: ";
+                std::getline(std::cin, query);
+                
+                std::vector<Book*> results;
+                if (!queryBooks(query, results)) {
+                    break;
+                }
+                if (results.empty()) {
+                    std::cout << "未找到匹配的图书！" << std::endl;
+                    break;
+                }
+                
+                std::cout << "找到 " << results.size() << " 本匹配的图书：" << std::endl;
+                std::cout << "=======================================" << std::endl;
+                for (Book* book : results) {
+                    book->display();
+                    std::cout << "=======================================" << std::endl;
                 }
                 break;
             }
-            case 2: {
-                int id;
-                std::cout << "请输入要删除的图书ID: ";
-                std::cin >> id;
+            case 10: {
+                std::string words;
+                int mode;
+                std::cin.ignore();
                 
-                if (removeBook(id)) {
-                    std::cout << "图书删除成功！" << std::endl;
-                } else {
-                    std::cout << "图书删除失败！" << std::endl;
+                std::cout << "请输入关键字（以空格分隔）: ";
+                std::getline(std::cin, words);
+                
+                std::cout << "1. 包含全部关键字  2. 包含任一关键字" << std::endl;
+                std::cout << "请选择: ";
+                std::cin >> mode;
+                
+                std::vector<Title*> results;
+                if (searchTitlesByWords(words, mode != 2, results)) {
+                    displayTitles(results);
                 }
                 break;
             }
-            case 3: {
-                std::string keyword;
+            case 11: {
+                std::string query;
                 std::cin.ignore();
                 
-                std::cout << "请输入关键字: ";
-                std::getline(std::cin, keyword);
+                std::cout << "请输入拼音或拼音首字母（如 luxun 或 lx）: ";
+                std::getline(std::cin, query);
                 
-                std::vector<Book*> results = searchBooks(keyword);
-                if (results.empty()) {
-                    std::cout << "未找到匹配的图书！" << std::endl;
-                } else {
-                    std::cout << "找到 " << results.size() << " 本匹配的图书：" << std::endl;
+                displayTitles(searchTitlesByPinyin(query));
+                break;
+            }
+            case 12: {
+                int order;
+                std::cout << "排序方式（0-按ID 1-按书名 2-按作者 3-按出版社）: ";
+                std::cin >> order;
+                if (order < ORDER_BY_ID || order > ORDER_BY_PUBLISHER) {
+                    order = ORDER_BY_ID;
+                }
+                
+                size_t pageCount = (books.size() + PAGE_SIZE - 1) / PAGE_SIZE;
+                size_t pageNumber = 1;
+                while (pageNumber >= 1 && pageNumber <= pageCount) {
+                    std::cout << "第 " << pageNumber << " / " << pageCount << " 页：" << std::endl;
                     std::cout << "=======================================" << std::endl;
-                    
-                    for (Book* book : results) {
+                    for (Book* book : sortedBooksPage(static_cast<SortOrder>(order), pageNumber - 1, PAGE_SIZE)) {
                         book->display();
                         std::cout << "=======================================" << std::endl;
                     }
+                    std::cout << "输入页码跳转，输入0返回: ";
+                    if (!(std::cin >> pageNumber)) {
+                        std::cin.clear();
+                        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                        break;
+                    }
+                }
+                if (pageCount == 0) {
+                    std::cout << "图书馆中没有图书！" << std::endl;
                 }
                 break;
             }
-            case 4:
-                displayAllBooks();
-                break;
             case 0:
                 return;
             default:
@@ -460,6 +2328,11 @@ void LibrarySystem::readerManagementMenu() {
         std::cout << "2. 删除读者" << std::endl;
         std::cout << "3. 查找读者" << std::endl;
         std::cout << "4. 显示所有读者" << std::endl;
+        std::cout << "5. 设置借阅上限" << std::endl;
+        std::cout << "6. 姓名联想" << std::endl;
+        std::cout << "7. 条件查询" << std::endl;
+        std::cout << "8. 拼音/首字母查找" << std::endl;
+        std::cout << "9. 排序分页浏览" << std::endl;
         std::cout << "0. 返回主菜单" << std::endl;
         std::cout << "============================================" << std::endl;
         
@@ -511,23 +2384,146 @@ void LibrarySystem::readerManagementMenu() {
                 std::cout << "请输入关键字: ";
                 std::getline(std::cin, keyword);
                 
-                std::vector<Reader*> results = searchReaders(keyword);
+                SearchCursor cursor;
+                int pageNumber = 0;
+                while (true) {
+                    std::vector<Reader*> page = searchReadersPage(keyword, cursor, PAGE_SIZE);
+                    if (page.empty()) {
+                        std::cout << (pageNumber == 0 ? "未找到匹配的读者！" : "没有更多结果了。") << std::endl;
+                        break;
+                    }
+                    
+                    std::cout << "第 " << ++pageNumber << " 页：" << std::endl;
+                    std::cout << "=======================================" << std::endl;
+                    for (Reader* reader : page) {
+                        reader->display();
+                        std::cout << "=======================================" << std::endl;
+                    }
+                    if (cursor.done) {
+                        break;
+                    }
+                    
+                    std::string answer;
+                    std::cout << "按回车显示下一页，输入0返回: ";
+                    if (!std::getline(std::cin, answer) || answer == "0") {
+                        break;
+                    }
+                }
+                break;
+            }
+            case 4: {
+                int order;
+                std::cout << "排序方式（0-按ID 1-按姓名）: ";
+                std::cin >> order;
+                displayAllReaders(order == 1 ? ORDER_BY_NAME : ORDER_BY_ID);
+                break;
+            }
+            case 5: {
+                int id, limit;
+                std::cout << "请输入读者ID: ";
+                std::cin >> id;
+                std::cout << "请输入借阅上限: ";
+                std::cin >> limit;
+                
+                if (setLoanLimit(id, limit)) {
+                    std::cout << "借阅上限设置成功！" << std::endl;
+                }
+                break;
+            }
+            case 6: {
+                std::string prefix;
+                std::cin.ignore();
+                
+                std::cout << "请输入姓名的开头: ";
+                std::getline(std::cin, prefix);
+                
+                std::vector<std::pair<std::string, int>> names = suggestReaders(prefix, 10);
+                if (names.empty()) {
+                    std::cout << "没有可联想的姓名！" << std::endl;
+                } else {
+                    for (const auto& name : names) {
+                        std::cout << name.first;
+                        if (name.second > 1) {
+                            std::cout << "（" << name.second << " 位同名）";
+                        }
+                        std::cout << std::endl;
+                    }
+                }
+                break;
+            }
+            case 7: {
+                std::string query;
+                std::cin.ignore();
+                
+                std::cout << "例：name:张 AND NOT contact:138，前面加 EXPLAIN 显示执行计划" << std::endl;
+                std::cout << "请输入查询条件: ";
+                std::getline(std::cin, query);
+                
+                std::vector<Reader*> results;
+                if (!queryReaders(query, results)) {
+                    break;
+                }
                 if (results.empty()) {
                     std::cout << "未找到匹配的读者！" << std::endl;
-                } else {
-                    std::cout << "找到 " << results.size() << " 位匹配的读者：" << std::endl;
+                    break;
+                }
+                
+                std::cout << "找到 " << results.size() << " 位匹配的读者：" << std::endl;
+                std::cout << "=======================================" << std::endl;
+                for (Reader* reader : results) {
+                    reader->display();
                     std::cout << "=======================================" << std::endl;
-                    
-                    for (Reader* reader : results) {
+                }
+                break;
+            }
+            case 8: {
+                std::string query;
+                std::cin.ignore();
+                
+                std::cout << "请输入姓名的拼音或拼音首字母: ";
+                std::getline(std::cin, query);
+                
+                std::vector<Reader*> results = searchReadersByPinyin(query);
+                if (results.empty()) {
+                    std::cout << "未找到匹配的读者！" << std::endl;
+                    break;
+                }
+                
+                std::cout << "找到 " << results.size() << " 位匹配的读者：" << std::endl;
+                std::cout << "=======================================" << std::endl;
+                for (Reader* reader : results) {
+                    reader->display();
+                    std::cout << "=======================================" << std::endl;
+                }
+                break;
+            }
+            case 9: {
+                int order;
+                std::cout << "排序方式（0-按ID 1-按姓名）: ";
+                std::cin >> order;
+                
+                size_t pageCount = (readers.size() + PAGE_SIZE - 1) / PAGE_SIZE;
+                size_t pageNumber = 1;
+                while (pageNumber >= 1 && pageNumber <= pageCount) {
+                    std::cout << "第 " << pageNumber << " / " << pageCount << " 页：" << std::endl;
+                    std::cout << "=======================================" << std::endl;
+                    for (Reader* reader : sortedReadersPage(order == 1 ? ORDER_BY_NAME : ORDER_BY_ID,
+                                                            pageNumber - 1, PAGE_SIZE)) {
                         reader->display();
                         std::cout << "=======================================" << std::endl;
                     }
+                    std::cout << "输入页码跳转，输入0返回: ";
+                    if (!(std::cin >> pageNumber)) {
+                        std::cin.clear();
+                        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                        break;
+                    }
+                }
+                if (pageCount == 0) {
+                    std::cout << "图书馆中没有读者！" << std::endl;
                 }
                 break;
             }
-            case 4:
-                displayAllReaders();
-                break;
             case 0:
                 return;
             default:
@@ -542,6 +2538,12 @@ void LibrarySystem::borrowReturnMenu() {
         std::cout << "\n==================借/还书==================" << std::endl;
         std::cout << "1. 借书" << std::endl;
         std::cout << "2. 还书" << std::endl;
+        std::cout << "3. 查看逾期图书" << std::endl;
+        std::cout << "4. 发送到期提醒" << std::endl;
+        std::cout << "5. 预约图书" << std::endl;
+        std::cout << "6. 取消预约" << std::endl;
+        std::cout << "7. 查看读者的预约" << std::endl;
+        std::cout << "8. 借还历史查询" << std::endl;
         std::cout << "0. 返回主菜单" << std::endl;
         std::cout << "===========================================" << std::endl;
         
@@ -581,6 +2583,273 @@ void LibrarySystem::borrowReturnMenu() {
                 returnBook(readerId, bookId);
                 break;
             }
+            case 3:
+                displayOverdueLoans();
+                break;
+            case 4:
+                sendDueReminders();
+                break;
+            case 5: {
+                int readerId, bookId;
+                
+                std::cout << "请输入读者ID: ";
+                std::cin >> readerId;
+                
+                std::cout << "请输入图书ID: ";
+                std::cin >> bookId;
+                
+                reserveBook(readerId, bookId);
+                break;
+            }
+            case 6: {
+                int readerId, bookId;
+                
+                std::cout << "请输入读者ID: ";
+                std::cin >> readerId;
+                
+                std::cout << "请输入图书ID: ";
+                std::cin >> bookId;
+                
+                cancelReservation(readerId, bookId);
+                break;
+            }
+            case 7: {
+                int readerId;
+                
+                std::cout << "请输入读者ID: ";
+                std::cin >> readerId;
+                
+                displayReservations(readerId);
+                break;
+            }
+            case 8:
+                historyMenu();
+                break;
+            case 0:
+                return;
+            default:
+                std::cout << "选择错误，请重新输入！" << std::endl;
+                break;
+        }
+    }
+}
+
+void LibrarySystem::dataMenu() {
+    while (true) {
+        std::cout << "\n==================数据导入/导出==================" << std::endl;
+        std::cout << "1. 导出为JSON Lines文件" << std::endl;
+        std::cout << "2. 从JSON Lines文件导入" << std::endl;
+        std::cout << "0. 返回主菜单" << std::endl;
+        std::cout << "=================================================" << std::endl;
+        
+        int choice;
+        std::cout << "请输入您的选择: ";
+        std::cin >> choice;
+        
+        if (std::cin.fail()) {
+            std::cin.clear();
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            std::cout << "输入错误，请重新输入！" << std::endl;
+            continue;
+        }
+        
+        switch (choice) {
+            case 1: {
+                std::string path;
+                std::cin.ignore();
+                
+                std::cout << "请输入导出文件路径: ";
+                std::getline(std::cin, path);
+                
+                exportJsonLines(path);
+                break;
+            }
+            case 2: {
+                std::string path;
+                std::cin.ignore();
+                
+                std::cout << "请输入导入文件路径: ";
+                std::getline(std::cin, path);
+                
+                importJsonLines(path);
+                break;
+            }
+            case 0:
+                return;
+            default:
+                std::cout << "选择错误，请重新输入！" << std::endl;
+                break;
+        }
+    }
+}
+
+void LibrarySystem::historyMenu() {
+    while (true) {
+        std::cout << "\n==================借还历史==================" << std::endl;
+        std::cout << "1. 按图书查询" << std::endl;
+        std::cout << "2. 按读者查询" << std::endl;
+        std::cout << "3. 按日期范围查询" << std::endl;
+        std::cout << "0. 返回上级菜单" << std::endl;
+        std::cout << "============================================" << std::endl;
+        
+        int choice;
+        std::cout << "请输入您的选择: ";
+        std::cin >> choice;
+        
+        if (std::cin.fail()) {
+            std::cin.clear();
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            std::cout << "输入错误，请重新输入！" << std::endl;
+            continue;
+        }
+        
+        switch (choice) {
+            case 1: {
+                int bookId;
+                std::cout << "请输入图书ID: ";
+                std::cin >> bookId;
+                
+                displayBookHistory(bookId);
+                break;
+            }
+            case 2: {
+                int readerId;
+                std::cout << "请输入读者ID: ";
+                std::cin >> readerId;
+                
+                displayReaderHistory(readerId);
+                break;
+            }
+            case 3: {
+                std::string fromText, toText;
+                std::time_t from, to;
+                
+                std::cout << "请输入开始日期(YYYY-MM-DD): ";
+                std::cin >> fromText;
+                
+                std::cout << "请输入结束日期(YYYY-MM-DD): ";
+                std::cin >> toText;
+                
+                if (!parseDate(fromText, from) || !parseDate(toText, to)) {
+                    std::cout << "日期格式错误！" << std::endl;
+                    break;
+                }
+                
+                // 结束日期包含当天
+                displayHistoryBetween(from, to + 24 * 3600 - 1);
+                break;
+            }
+            case 0:
+                return;
+            default:
+                std::cout << "选择错误，请重新输入！" << std::endl;
+                break;
+        }
+    }
+}
+
+void LibrarySystem::displayCollectionSummary() const {
+    size_t borrowed = borrowedBookCount();
+    std::cout << "馆藏图书: " << titleIndex.size() << " 种，" << books.size() << " 册" << std::endl;
+    std::cout << "可借: " << books.size() - borrowed << " 册" << std::endl;
+    std::cout << "已借出: " << borrowed << " 册" << std::endl;
+}
+
+void LibrarySystem::displayCacheStats() const {
+    size_t hits = queryCache.getHits();
+    size_t total = hits + queryCache.getMisses();
+    std::cout << "查询缓存: " << queryCache.size() << " 项" << std::endl;
+    std::cout << "命中 " << hits << " 次，共查询 " << total << " 次";
+    if (total > 0) {
+        std::cout << "，命中率 " << hits * 100.0 / total << "%";
+    }
+    std::cout << std::endl;
+}
+
+// 查找结果按作者、出版社的分布：每册结果换成所属书目ID，再按书目查分面值累加
+void LibrarySystem::displaySearchFacets(const std::vector<int>& matches, size_t k) const {
+    if (matches.empty()) {
+        return;
+    }
+    std::vector<int> titleIds;
+    titleIds.reserve(matches.size());
+    for (int id : matches) {
+        titleIds.push_back(books.find(id)->getTitle()->getId());
+    }
+    std::cout << "共 " << matches.size() << " 册，结果分布：" << std::endl;
+    displayFacets("作者", authorFacets, titleIds, k);
+    displayFacets("出版社", publisherFacets, titleIds, k);
+}
+
+void LibrarySystem::displayFacets(const char* label, const FacetIndex& facets, const std::vector<int>& titleIds,
+                                  size_t k) const {
+    std::cout << "按" << label << "：" << std::endl;
+    for (const FacetIndex::Count& entry : facets.count(titleIds, k)) {
+        std::cout << "  " << facets.getValue(entry.value) << "：" << entry.matched << " 册（馆藏 "
+                  << facets.getTotal(entry.value) << " 册，可借 " << facets.getAvailable(entry.value) 
+                  << " 册）" << std::endl;
+    }
+}
+
+void LibrarySystem::displayFacetSummary(size_t k) const {
+    const FacetIndex* facets[] = {&authorFacets, &publisherFacets};
+    const char* labels[] = {"作者", "出版社"};
+    for (size_t i = 0; i < 2; ++i) {
+        std::vector<int> top = facets[i]->top(k);
+        if (top.empty()) {
+            std::cout << "图书馆中没有图书！" << std::endl;
+            return;
+        }
+        std::cout << "馆藏最多的" << labels[i] << "：" << std::endl;
+        for (int value : top) {
+            std::cout << "  " << facets[i]->getValue(value) << "：馆藏 " << facets[i]->getTotal(value) 
+                      << " 册，可借 " << facets[i]->getAvailable(value) << " 册" << std::endl;
+        }
+    }
+}
+
+void LibrarySystem::statisticsMenu() {
+    while (true) {
+        std::cout << "\n==================统计信息==================" << std::endl;
+        std::cout << "1. 本周热门图书" << std::endl;
+        std::cout << "2. 本周活跃读者" << std::endl;
+        std::cout << "3. 精确重算并校验统计误差" << std::endl;
+        std::cout << "4. 馆藏概况" << std::endl;
+        std::cout << "5. 查询缓存命中率" << std::endl;
+        std::cout << "6. 按作者/出版社统计" << std::endl;
+        std::cout << "0. 返回主菜单" << std::endl;
+        std::cout << "============================================" << std::endl;
+        
+        int choice;
+        std::cout << "请输入您的选择: ";
+        std::cin >> choice;
+        
+        if (std::cin.fail()) {
+            std::cin.clear();
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            std::cout << "输入错误，请重新输入！" << std::endl;
+            continue;
+        }
+        
+        switch (choice) {
+            case 1:
+                displayPopularBooks(10);
+                break;
+            case 2:
+                displayActiveReaders(10);
+                break;
+            case 3:
+                validatePopularity();
+                break;
+            case 4:
+                displayCollectionSummary();
+                break;
+            case 5:
+                displayCacheStats();
+                break;
+            case 6:
+                displayFacetSummary(10);
+                break;
             case 0:
                 return;
             default:
@@ -4,49 +4,208 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <memory>
+#include <unordered_map>
+#include "Title.h"
 #include "Book.h"
 #include "Reader.h"
+#include "ThreadPool.h"
+#include "LoanSchedule.h"
+#include "HoldQueue.h"
+#include "CirculationLog.h"
+#include "Popularity.h"
+#include "CoBorrowIndex.h"
+#include "IdAllocator.h"
+#include "DenseTable.h"
+#include "BitSet.h"
+#include "TextArena.h"
+#include "PrefixTrie.h"
+#include "FuzzyIndex.h"
+#include "Pinyin.h"
+#include "Bm25Index.h"
+#include "QueryCache.h"
+#include "QueryProgram.h"
+#include "SortedView.h"
+#include "FacetIndex.h"
+
+// 按借阅状态筛选图书
+enum AvailabilityFilter {
+    FILTER_ANY,          // 不限
+    FILTER_AVAILABLE,    // 只要可借的副本
+    FILTER_BORROWED      // 只要已借出的副本
+};
+
+// 显示和分页浏览的排序方式，名称按拼音排序（见collationKey）；读者只能按ID或姓名排序
+enum SortOrder {
+    ORDER_BY_ID,
+    ORDER_BY_NAME,       // 书名或读者姓名
+    ORDER_BY_AUTHOR,
+    ORDER_BY_PUBLISHER
+};
+
+// 分页查找的续查位置。结果按ID升序产生，after是上一页最后一条结果的ID，
+// 下一页从更大的ID继续扫描；只依赖ID，两页之间增删记录也能正确续查，
+// after本身即可作为续查令牌传给调用方保存
+struct SearchCursor {
+    int after;      // 0表示从头开始
+    bool done;      // 已没有更多结果
+    SearchCursor() : after(0), done(false) {}
+};
 
 class LibrarySystem {
 private:
-    std::vector<Book> books;
-    std::vector<Reader> readers;
+    DenseTable<Book> books;       // 下标即图书ID
+    DenseTable<Reader> readers;   // 下标即读者ID
+    BitSet borrowedBits;          // 按图书ID索引的借出状态，与books的存活位逐字运算
+    std::vector<std::shared_ptr<Title>> titles;      // 下标即书目ID，已删除的书目为空
+    std::unordered_map<std::string, int> titleIndex; // 书名+作者+出版社 -> 书目ID
+    TextArena titleText;     // 书目可检索文本的连续存储，没有索引可用时直接扫描
+    // 相关度查找和容错查找用的索引，第一次查找时才建立，之后随书目增量维护
+    mutable Bm25Index titleTerms;    // 书目词项倒排表，按相关度取前k个
+    mutable FuzzyIndex titleFuzzy;   // 书目字段的二元组倒排表，供容错查找过滤候选
+    mutable PinyinIndex titlePinyin;     // 书名、作者的拼音和首字母
+    mutable PinyinIndex readerPinyin;    // 读者姓名的拼音和首字母
+    mutable bool searchIndexesReady;
+    // 按名称排序的视图，第一次按名称排序浏览时才建立，之后随图书、读者增删增量维护
+    mutable SortedView bookViews[3];     // 依次按书名、作者、出版社
+    mutable SortedView readerView;       // 按读者姓名
+    mutable bool sortedViewsReady;
+    mutable QueryCache queryCache;           // 按借阅状态查找图书的结果缓存
+    mutable std::vector<int> matchBuffer;    // 未缓存的查找结果
+    FacetIndex authorFacets;     // 按作者的分面，书目ID -> 作者
+    FacetIndex publisherFacets;  // 按出版社的分面，书目ID -> 出版社
+    PrefixTrie titleNames;   // 书名联想，次数为同名书目数
+    PrefixTrie authorNames;  // 作者联想，次数为该作者的书目数
+    PrefixTrie readerNames;  // 读者姓名联想，次数为同名读者数
     std::string bookFile;
     std::string readerFile;
-    int nextBookId;
-    int nextReaderId;
+    std::string loanFile;
+    std::string holdFile;
+    std::string historyFile;
+    std::string idFile;
+    IdAllocator bookIds;     // 图书ID分配
+    IdAllocator readerIds;   // 读者ID分配
+    LoanSchedule loans;      // 借阅记录，按应还时间排列
+    HoldQueues holds;        // 每个书目的预约队列
+    CirculationLog history;  // 借还历史
+    TopKTracker popularTitles;   // 本周借阅最多的书目
+    TopKTracker activeReaders;   // 本周借阅最多的读者
+    std::time_t statsWindowStart;  // 统计窗口（本周一零点）
+    CoBorrowIndex coBorrows;     // 同一读者借阅过的书目之间的共现次数
     
     // 辅助函数
-    void loadBooks();
+    void loadBooks(ThreadPool& pool);
     void saveBooks();
-    void loadReaders();
+    void loadReaders(ThreadPool& pool);
     void saveReaders();
+    void loadLoans();
+    void saveLoans();
+    void syncLoans();
+    void reconcileLoans();
+    void setBorrowed(Book& book, bool status);
+    void loadIds();
+    void saveIds();
+    std::time_t lendBook(Reader& reader, Book& book);
+    void handOffToHolder(Book& book);
+    void displayHistoryEvent(const HistoryEvent& event) const;
+    
+    // 热门统计
+    static std::time_t weekStart(std::time_t time);
+    void recordPopularity(int titleId, int readerId, std::time_t time);
+    void rebuildPopularity();
+    void rebuildRecommendations();
+    void displayRecommendations(int titleId) const;
+    void displayTitles(const std::vector<Title*>& results) const;
+    void displayFacets(const char* label, const FacetIndex& facets, const std::vector<int>& titleIds, 
+                       size_t k) const;
+    
+    // 书目维护
+    static std::string titleKey(const std::string& name, const std::string& author, 
+                                const std::string& publisher);
+    void attachTitle(Book& book);
+    void detachTitle(Book& book);
+    void rebuildTitles();
+    void buildSearchIndexes() const;
+    void buildSortedViews() const;
+    void addToSortedViews(const Book& book) const;
+    void removeFromSortedViews(const Book& book) const;
     
     // 查找函数
-    int findBookIndex(int id) const;
-    int findReaderIndex(int id) const;
+    const std::vector<int>& matchBooks(const std::string& keyword, AvailabilityFilter filter) const;
+    const Book* findBook(int id) const;
+    const Reader* findReader(int id) const;
 
 public:
-    LibrarySystem(const std::string& bookFile = "book.dat", const std::string& readerFile = "reader.dat");
+    LibrarySystem(const std::string& bookFile = "book.dat", const std::string& readerFile = "reader.dat",
+                  const std::string& loanFile = "loan.dat", const std::string& holdFile = "hold.dat",
+                  const std::string& historyFile = "history.dat", const std::string& idFile = "id.dat");
     ~LibrarySystem();
     
     // 图书管理
-    bool addBook(const std::string& name, const std::string& author, const std::string& publisher);
+    bool addBook(const std::string& name, const std::string& author, const std::string& publisher,
+                 int copies = 1);
     bool removeBook(int id);
     Book* findBook(int id);
-    void displayAllBooks() const;
-    std::vector<Book*> searchBooks(const std::string& keyword) const;
+    void displayAllBooks(SortOrder order = ORDER_BY_ID) const;
+    std::vector<Book*> sortedBooksPage(SortOrder order, size_t page, size_t pageSize) const;
+    std::vector<Book*> searchBooks(const std::string& keyword, AvailabilityFilter filter = FILTER_ANY) const;
+    std::vector<Book*> searchBooksPage(const std::vector<int>& matches, SearchCursor& cursor, 
+                                       size_t pageSize) const;
+    size_t availableBookCount() const;
+    size_t borrowedBookCount() const;
+    Title* findTitle(int id);
+    std::vector<Title*> searchTitles(const std::string& keyword) const;
+    bool queryBooks(const std::string& query, std::vector<Book*>& results) const;
+    bool searchTitlesByWords(const std::string& words, bool matchAll, std::vector<Title*>& results) const;
+    std::vector<Title*> searchTitlesByPinyin(const std::string& query) const;
+    std::vector<std::pair<Title*, double>> rankTitles(const std::string& keyword, size_t k) const;
+    bool fuzzySearchTitles(const std::string& keyword, int maxErrors,
+                           std::vector<std::pair<Title*, int>>& results) const;
+    std::vector<std::pair<std::string, int>> suggestTitles(const std::string& prefix, size_t k) const;
+    std::vector<std::pair<std::string, int>> suggestAuthors(const std::string& prefix, size_t k) const;
     
     // 读者管理
     bool addReader(const std::string& name, const std::string& contact);
     bool removeReader(int id);
     Reader* findReader(int id);
-    void displayAllReaders() const;
+    bool setLoanLimit(int readerId, int limit);
+    void displayAllReaders(SortOrder order = ORDER_BY_ID) const;
+    std::vector<Reader*> sortedReadersPage(SortOrder order, size_t page, size_t pageSize) const;
     std::vector<Reader*> searchReaders(const std::string& keyword) const;
+    std::vector<Reader*> searchReadersPage(const std::string& keyword, SearchCursor& cursor, 
+                                           size_t pageSize) const;
+    std::vector<Reader*> searchReadersByPinyin(const std::string& query) const;
+    bool queryReaders(const std::string& query, std::vector<Reader*>& results) const;
+    std::vector<std::pair<std::string, int>> suggestReaders(const std::string& prefix, size_t k) const;
     
     // 借还书操作
     bool borrowBook(int readerId, int bookId);
     bool returnBook(int readerId, int bookId);
+    void displayOverdueLoans() const;
+    
+    // 预约
+    bool reserveBook(int readerId, int bookId);
+    bool cancelReservation(int readerId, int bookId);
+    void displayReservations(int readerId) const;
+    
+    // 借还历史
+    void displayBookHistory(int bookId) const;
+    void displayReaderHistory(int readerId) const;
+    void displayHistoryBetween(std::time_t from, std::time_t to) const;
+    
+    // 统计
+    void displayPopularBooks(size_t k) const;
+    void displayActiveReaders(size_t k) const;
+    void validatePopularity() const;
+    void displayCollectionSummary() const;
+    void displayCacheStats() const;
+    void displaySearchFacets(const std::vector<int>& matches, size_t k) const;
+    void displayFacetSummary(size_t k) const;
+    void sendDueReminders();
+    
+    // 数据导入/导出（JSON Lines）
+    bool exportJsonLines(const std::string& path) const;
+    bool importJsonLines(const std::string& path);
     
     // 菜单函数
     void run();
@@ -54,6 +213,9 @@ public:
     void bookManagementMenu();
     void readerManagementMenu();
     void borrowReturnMenu();
+    void dataMenu();
+    void historyMenu();
+    void statisticsMenu();
 };
 
 #endif // LIBRARY_SYSTEM_H 
\ No newline at end of file
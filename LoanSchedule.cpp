@@ -0,0 +1,191 @@
+#include "LoanSchedule.h"
+#include <fstream>
+#include <algorithm>
+#include <sstream>
+
+void LoanSchedule::swapNodes(size_t a, size_t b) {
+    std::swap(heap[a], heap[b]);
+    position[heap[a].bookId] = a;
+    position[heap[b].bookId] = b;
+}
+
+void LoanSchedule::siftUp(size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (heap[parent].dueTime <= heap[i].dueTime) {
+            break;
+        }
+        swapNodes(i, parent);
+        i = parent;
+    }
+}
+
+void LoanSchedule::siftDown(size_t i) {
+    while (true) {
+        size_t smallest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        if (left < heap.size() && heap[left].dueTime < heap[smallest].dueTime) {
+            smallest = left;
+        }
+        if (right < heap.size() && heap[right].dueTime < heap[smallest].dueTime) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            break;
+        }
+        swapNodes(i, smallest);
+        i = smallest;
+    }
+}
+
+std::vector<size_t> LoanSchedule::dueIndices(std::time_t now) const {
+    std::vector<size_t> result;
+    if (heap.empty() || heap[0].dueTime > now) {
+        return result;
+    }
+
+    // 堆序保证子结点不早于父结点，父结点未到期时整棵子树都不用看
+    std::vector<size_t> stack;
+    stack.push_back(0);
+    while (!stack.empty()) {
+        size_t i = stack.back();
+        stack.pop_back();
+        result.push_back(i);
+        for (size_t child = 2 * i + 1; child <= 2 * i + 2 && child < heap.size(); ++child) {
+            if (heap[child].dueTime <= now) {
+                stack.push_back(child);
+            }
+        }
+    }
+    return result;
+}
+
+bool LoanSchedule::add(const Loan& loan) {
+    if (position.count(loan.bookId)) {
+        return false;
+    }
+    heap.push_back(loan);
+    position[loan.bookId] = heap.size() - 1;
+    siftUp(heap.size() - 1);
+    return true;
+}
+
+bool LoanSchedule::remove(int bookId) {
+    auto it = position.find(bookId);
+    if (it == position.end()) {
+        return false;
+    }
+
+    size_t i = it->second;
+    size_t last = heap.size() - 1;
+    if (i != last) {
+        swapNodes(i, last);
+    }
+    position.erase(bookId);
+    heap.pop_back();
+
+    if (i < heap.size()) {
+        siftUp(i);
+        siftDown(position[heap[i].bookId]);
+    }
+    return true;
+}
+
+const Loan* LoanSchedule::find(int bookId) const {
+    auto it = position.find(bookId);
+    if (it == position.end()) {
+        return nullptr;
+    }
+    return &heap[it->second];
+}
+
+size_t LoanSchedule::size() const {
+    return heap.size();
+}
+
+void LoanSchedule::clear() {
+    heap.clear();
+    position.clear();
+}
+
+std::vector<Loan> LoanSchedule::overdue(std::time_t now) const {
+    std::vector<Loan> result;
+    for (size_t i : dueIndices(now)) {
+        result.push_back(heap[i]);
+    }
+    std::sort(result.begin(), result.end(), [](const Loan& a, const Loan& b) {
+        return a.dueTime < b.dueTime;
+    });
+    return result;
+}
+
+size_t LoanSchedule::fireReminders(std::time_t now, const std::function<void(const Loan&)>& remind) {
+    size_t count = 0;
+    for (size_t i : dueIndices(now)) {
+        if (!heap[i].reminded) {
+            heap[i].reminded = true;
+            remind(heap[i]);
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool LoanSchedule::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    clear();
+    Loan loan;
+    long long borrowTime, dueTime;
+    while (file >> loan.bookId >> loan.readerId >> borrowTime >> dueTime >> loan.reminded) {
+        loan.borrowTime = static_cast<std::time_t>(borrowTime);
+        loan.dueTime = static_cast<std::time_t>(dueTime);
+        add(loan);
+    }
+    return true;
+}
+
+bool LoanSchedule::save(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    for (const Loan& loan : heap) {
+        file << loan.bookId << " " << loan.readerId << " "
+             << static_cast<long long>(loan.borrowTime) << " "
+             << static_cast<long long>(loan.dueTime) << " " << loan.reminded << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+std::string formatDate(std::time_t time) {
+    char text[16];
+    std::tm* local = std::localtime(&time);
+    if (!local || std::strftime(text, sizeof(text), "%Y-%m-%d", local) == 0) {
+        return "?";
+    }
+    return text;
+}
+
+bool parseDate(const std::string& text, std::time_t& time) {
+    int year, month, day;
+    char dash1, dash2;
+    std::istringstream is(text);
+    if (!(is >> year >> dash1 >> month >> dash2 >> day) || dash1 != '-' || dash2 != '-' ||
+        month < 1 || month > 12 || day < 1 || day > 31) {
+        return false;
+    }
+
+    std::tm local = {};
+    local.tm_year = year - 1900;
+    local.tm_mon = month - 1;
+    local.tm_mday = day;
+    local.tm_isdst = -1;
+    time = std::mktime(&local);
+    return time != static_cast<std::time_t>(-1);
+}
@@ -0,0 +1,57 @@
+#ifndef LOAN_SCHEDULE_H
+#define LOAN_SCHEDULE_H
+
+#include <ctime>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+
+// 一条借阅记录
+struct Loan {
+    int bookId;              // 图书ID（同一本书同一时间只能借给一位读者）
+    int readerId;            // 读者ID
+    std::time_t borrowTime;  // 借出时间
+    std::time_t dueTime;     // 应还时间
+    bool reminded;           // 是否已发送过到期提醒
+};
+
+// 按应还时间组织的借阅记录：带位置索引的二叉小根堆。
+// 增删为O(log n)；列出逾期记录时只访问应还时间不晚于当前时间的结点，
+// 代价与逾期记录数成正比，而不是扫描全部借阅。
+class LoanSchedule {
+private:
+    std::vector<Loan> heap;
+    std::unordered_map<int, size_t> position;   // 图书ID -> 堆中下标
+
+    void swapNodes(size_t a, size_t b);
+    void siftUp(size_t i);
+    void siftDown(size_t i);
+    // 所有应还时间不晚于now的结点下标（只沿堆中满足条件的路径向下搜索）
+    std::vector<size_t> dueIndices(std::time_t now) const;
+
+public:
+    static const int DEFAULT_LOAN_DAYS = 30;   // 默认借期（天）
+
+    bool add(const Loan& loan);
+    bool remove(int bookId);
+    const Loan* find(int bookId) const;
+    size_t size() const;
+    void clear();
+
+    // 列出逾期记录，按应还时间升序
+    std::vector<Loan> overdue(std::time_t now) const;
+    // 对尚未提醒过的逾期记录调用remind，并标记为已提醒；返回本次提醒的数量
+    size_t fireReminders(std::time_t now, const std::function<void(const Loan&)>& remind);
+
+    // 文件读写，每行一条：图书ID 读者ID 借出时间 应还时间 是否已提醒
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+};
+
+// 把时间格式化为YYYY-MM-DD
+std::string formatDate(std::time_t time);
+// 解析YYYY-MM-DD格式的日期（当天零点），格式错误时返回false
+bool parseDate(const std::string& text, std::time_t& time);
+
+#endif // LOAN_SCHEDULE_H
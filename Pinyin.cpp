@@ -0,0 +1,145 @@
+#include "Pinyin.h"
+#include "TextFold.h"
+#include <algorithm>
+
+namespace {
+
+inline bool isAsciiAlnum(unsigned char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z');
+}
+
+// 解码pos处的UTF-8字符并前移pos，格式不正确时按1字节处理并返回0
+char32_t decode(const std::string& text, size_t& pos) {
+    unsigned char c = static_cast<unsigned char>(text[pos]);
+    size_t length = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+    if (length == 1 || pos + length > text.size()) {
+        ++pos;
+        return c < 0x80 ? c : 0;
+    }
+    char32_t code = c & (0x3F >> (length - 1));
+    for (size_t i = 1; i < length; ++i) {
+        code = (code << 6) | (static_cast<unsigned char>(text[pos + i]) & 0x3F);
+    }
+    pos += length;
+    return code;
+}
+
+} // namespace
+
+bool toPinyin(const std::string& text, std::string& full, std::string& initials) {
+    full.clear();
+    initials.clear();
+    std::string folded;
+    foldText(text, folded);
+    bool han = false;
+    size_t pos = 0;
+    while (pos < folded.size()) {
+        char32_t c = decode(folded, pos);
+        if (c < 0x80) {
+            if (isAsciiAlnum(static_cast<unsigned char>(c))) {
+                full += static_cast<char>(c);
+                initials += static_cast<char>(c);
+            }
+            continue;
+        }
+        const char* syllable = pinyinOf(c);
+        if (syllable) {
+            full += syllable;
+            initials += syllable[0];
+            han = true;
+        }
+    }
+    return han;
+}
+
+void collationKey(const std::string& text, std::string& key) {
+    key.clear();
+    std::string folded;
+    foldText(text, folded);
+    bool ascii = true;
+    size_t pos = 0;
+    while (pos < folded.size()) {
+        size_t start = pos;
+        char32_t c = decode(folded, pos);
+        if (c < 0x80 && pos == start + 1) {
+            key += folded[start];
+            continue;
+        }
+        ascii = false;
+        const char* syllable = pinyinOf(c);
+        if (syllable) {
+            key += syllable;
+        } else {
+            key.append(folded, start, pos - start);
+        }
+    }
+    if (!ascii) {
+        key += '\x1f';
+        key += folded;
+    }
+}
+
+void PinyinIndex::addKey(int ownerId, const std::string& key) {
+    KeyMap::iterator it = keys.try_emplace(key).first;
+    std::vector<int>& ids = it->second;
+    std::vector<KeyMap::iterator>& owned = keysOf[ownerId];
+    // 全拼与首字母相同（如单字）或两个字段同音时只记一次
+    if (std::find(owned.begin(), owned.end(), it) != owned.end()) {
+        return;
+    }
+    ids.insert(std::lower_bound(ids.begin(), ids.end(), ownerId), ownerId);
+    owned.push_back(it);
+}
+
+void PinyinIndex::add(int ownerId, std::initializer_list<const std::string*> fields) {
+    remove(ownerId);
+    std::string full;
+    std::string initials;
+    for (const std::string* field : fields) {
+        if (toPinyin(*field, full, initials)) {
+            addKey(ownerId, full);
+            addKey(ownerId, initials);
+        }
+    }
+}
+
+void PinyinIndex::remove(int ownerId) {
+    auto owner = keysOf.find(ownerId);
+    if (owner == keysOf.end()) {
+        return;
+    }
+    for (KeyMap::iterator it : owner->second) {
+        std::vector<int>& ids = it->second;
+        ids.erase(std::lower_bound(ids.begin(), ids.end(), ownerId));
+        if (ids.empty()) {
+            keys.erase(it);
+        }
+    }
+    keysOf.erase(owner);
+}
+
+void PinyinIndex::clear() {
+    keys.clear();
+    keysOf.clear();
+}
+
+std::vector<int> PinyinIndex::search(const std::string& query) const {
+    std::vector<int> results;
+    std::string prefix;
+    std::string initials;
+    toPinyin(query, prefix, initials);
+    if (prefix.empty()) {
+        return results;
+    }
+
+    for (auto it = keys.lower_bound(prefix); it != keys.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+        results.insert(results.end(), it->second.begin(), it->second.end());
+    }
+    std::sort(results.begin(), results.end());
+    results.erase(std::unique(results.begin(), results.end()), results.end());
+    return results;
+}
+
+size_t PinyinIndex::size() const {
+    return keysOf.size();
+}
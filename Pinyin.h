@@ -0,0 +1,48 @@
+#ifndef PINYIN_H
+#define PINYIN_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 汉字（U+4E00～U+9FFF）的无声调拼音，不是汉字或表中没有时返回nullptr。
+// 对照表编译在PinyinTable.cpp中，不依赖外部服务
+const char* pinyinOf(char32_t c);
+
+// 把文本（先经foldText规范化）转写为检索用的拼音键：汉字换成拼音，ASCII字母和数字原样保留，
+// 其余字符（空格、标点、查不到拼音的字）去掉。full为全拼（如“鲁迅”为“luxun”），
+// initials中每个汉字只取拼音首字母（“lx”）。含有可转写的汉字时返回true
+bool toPinyin(const std::string& text, std::string& full, std::string& initials);
+
+// 排序键：文本经foldText规范化后，汉字换成拼音，其余字符原样保留，
+// 按字节比较时中文按拼音、英文按字母顺序混排。含有非ASCII字符时在后面加'\x1f'和规范化的原文，
+// 同音字也有确定的先后
+void collationKey(const std::string& text, std::string& key);
+
+// 拼音和拼音首字母索引：每条记录各字段的全拼键和首字母键有序存放，
+// 查询时按前缀在有序表中定位，只访问匹配的键。
+// 不含汉字的字段不建键（直接用原文查找即可）。增删记录只修改该记录的几个键
+class PinyinIndex {
+private:
+    typedef std::map<std::string, std::vector<int>> KeyMap;   // 拼音键 -> 记录ID（升序）
+
+    KeyMap keys;
+    std::unordered_map<int, std::vector<KeyMap::iterator>> keysOf;   // 记录ID -> 它的键，删除时用
+
+    void addKey(int ownerId, const std::string& key);
+
+public:
+    void add(int ownerId, std::initializer_list<const std::string*> fields);
+    void remove(int ownerId);
+    void clear();
+
+    // 全拼或首字母以query开头的记录ID，升序。query同样经toPinyin转写，
+    // 空格、撇号等被忽略，其中的汉字按全拼匹配
+    std::vector<int> search(const std::string& query) const;
+    size_t size() const;
+};
+
+#endif // PINYIN_H
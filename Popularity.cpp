@@ -0,0 +1,131 @@
+#include "Popularity.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+std::uint64_t mix64(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+} // namespace
+
+CountMinSketch::CountMinSketch(size_t width, size_t depth)
+    : width(width), depth(depth), table(width * depth, 0), total(0) {}
+
+size_t CountMinSketch::slot(size_t row, std::uint64_t key) const {
+    // 每一行用不同的种子得到相互独立的哈希
+    return row * width + static_cast<size_t>(mix64(key ^ (0xA24BAED4963EE407ULL * (row + 1))) % width);
+}
+
+void CountMinSketch::add(std::uint64_t key, std::uint32_t count) {
+    for (size_t row = 0; row < depth; ++row) {
+        table[slot(row, key)] += count;
+    }
+    total += count;
+}
+
+std::uint32_t CountMinSketch::estimate(std::uint64_t key) const {
+    std::uint32_t result = UINT32_MAX;
+    for (size_t row = 0; row < depth; ++row) {
+        result = std::min(result, table[slot(row, key)]);
+    }
+    return result;
+}
+
+std::uint64_t CountMinSketch::getTotal() const {
+    return total;
+}
+
+double CountMinSketch::errorBound() const {
+    return std::exp(1.0) / static_cast<double>(width) * static_cast<double>(total);
+}
+
+double CountMinSketch::failureProbability() const {
+    return std::exp(-static_cast<double>(depth));
+}
+
+void CountMinSketch::clear() {
+    std::fill(table.begin(), table.end(), 0);
+    total = 0;
+}
+
+TopKTracker::TopKTracker(size_t capacity) : capacity(capacity) {}
+
+void TopKTracker::siftDown(size_t i) {
+    while (true) {
+        size_t smallest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        if (left < heap.size() && heap[left] < heap[smallest]) {
+            smallest = left;
+        }
+        if (right < heap.size() && heap[right] < heap[smallest]) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            return;
+        }
+        std::swap(heap[i], heap[smallest]);
+        i = smallest;
+    }
+}
+
+void TopKTracker::siftUp(size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!(heap[i] < heap[parent])) {
+            return;
+        }
+        std::swap(heap[i], heap[parent]);
+        i = parent;
+    }
+}
+
+void TopKTracker::add(int id) {
+    sketch.add(static_cast<std::uint32_t>(id));
+    std::uint32_t count = sketch.estimate(static_cast<std::uint32_t>(id));
+
+    // 堆的容量很小，直接线性查找
+    for (size_t i = 0; i < heap.size(); ++i) {
+        if (heap[i].second == id) {
+            heap[i].first = count;
+            siftDown(i);
+            return;
+        }
+    }
+
+    if (heap.size() < capacity) {
+        heap.emplace_back(count, id);
+        siftUp(heap.size() - 1);
+    } else if (capacity > 0 && count > heap[0].first) {
+        heap[0] = std::make_pair(count, id);
+        siftDown(0);
+    }
+}
+
+std::vector<std::pair<int, std::uint32_t>> TopKTracker::top(size_t k) const {
+    std::vector<std::pair<std::uint32_t, int>> sorted(heap);
+    std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::uint32_t, int>& a,
+                                               const std::pair<std::uint32_t, int>& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+
+    std::vector<std::pair<int, std::uint32_t>> result;
+    for (size_t i = 0; i < sorted.size() && i < k; ++i) {
+        result.emplace_back(sorted[i].second, sorted[i].first);
+    }
+    return result;
+}
+
+const CountMinSketch& TopKTracker::getSketch() const {
+    return sketch;
+}
+
+void TopKTracker::clear() {
+    sketch.clear();
+    heap.clear();
+}
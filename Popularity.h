@@ -0,0 +1,54 @@
+#ifndef POPULARITY_H
+#define POPULARITY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+// Count-Min Sketch：固定大小的计数矩阵，估计值只会偏大，
+// 以1 - e^(-depth)的概率误差不超过 (e / width) * 总次数
+class CountMinSketch {
+private:
+    size_t width;
+    size_t depth;
+    std::vector<std::uint32_t> table;
+    std::uint64_t total;
+
+    size_t slot(size_t row, std::uint64_t key) const;
+
+public:
+    CountMinSketch(size_t width = 2048, size_t depth = 4);
+
+    void add(std::uint64_t key, std::uint32_t count = 1);
+    std::uint32_t estimate(std::uint64_t key) const;
+    std::uint64_t getTotal() const;
+    // 误差上界 (e / width) * 总次数
+    double errorBound() const;
+    // 误差超过上界的概率 e^(-depth)
+    double failureProbability() const;
+    void clear();
+};
+
+// 流式Top-K：Count-Min Sketch估计次数，再用容量为k的小根堆保留估计值最大的k个ID。
+// 内存占用固定，与图书、读者的总数无关。
+class TopKTracker {
+private:
+    size_t capacity;
+    CountMinSketch sketch;
+    std::vector<std::pair<std::uint32_t, int>> heap;   // (估计次数, ID)，堆顶最小
+
+    void siftDown(size_t i);
+    void siftUp(size_t i);
+
+public:
+    explicit TopKTracker(size_t capacity = 20);
+
+    void add(int id);
+    // 按估计次数降序返回
+    std::vector<std::pair<int, std::uint32_t>> top(size_t k) const;
+    const CountMinSketch& getSketch() const;
+    void clear();
+};
+
+#endif // POPULARITY_H
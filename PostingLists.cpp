@@ -0,0 +1,169 @@
+#include "PostingLists.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define POSTING_LISTS_SSE2 1
+#endif
+
+namespace {
+
+// 长表长度超过短表的这么多倍时改用跳跃查找
+const size_t GALLOP_RATIO = 32;
+
+// 从from开始在list中找第一个不小于value的位置：步长逐次加倍找到区间后再二分
+size_t gallop(const std::vector<int>& list, size_t from, int value) {
+    size_t step = 1;
+    size_t low = from;
+    size_t high = from;
+    while (high < list.size() && list[high] < value) {
+        low = high + 1;
+        high = from + step;
+        step *= 2;
+    }
+    high = std::min(high, list.size());
+    return std::lower_bound(list.begin() + low, list.begin() + high, value) - list.begin();
+}
+
+void intersectGallop(const std::vector<int>& small, const std::vector<int>& large, std::vector<int>& out) {
+    size_t pos = 0;
+    for (int value : small) {
+        pos = gallop(large, pos, value);
+        if (pos == large.size()) {
+            break;
+        }
+        if (large[pos] == value) {
+            out.push_back(value);
+            ++pos;
+        }
+    }
+}
+
+void intersectMerge(const int* a, size_t n, const int* b, size_t m, std::vector<int>& out) {
+    size_t i = 0;
+    size_t j = 0;
+    while (i < n && j < m) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            out.push_back(a[i]);
+            ++i;
+            ++j;
+        }
+    }
+}
+
+#ifdef POSTING_LISTS_SSE2
+// 每次取a、b各4个元素，b依次轮转3次与a逐位比较，得到a中哪几个元素在b的这4个里；
+// 然后末元素较小的一方前进4个（相等时两方都前进）。剩余不足4个的部分逐个归并
+void intersectSse2(const int* a, size_t n, const int* b, size_t m, std::vector<int>& out) {
+    size_t i = 0;
+    size_t j = 0;
+    while (i + 4 <= n && j + 4 <= m) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+        __m128i eq = _mm_cmpeq_epi32(va, vb);
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        for (int lane = 0; mask != 0; ++lane, mask >>= 1) {
+            if (mask & 1) {
+                out.push_back(a[i + lane]);
+            }
+        }
+
+        int lastA = a[i + 3];
+        int lastB = b[j + 3];
+        if (lastA <= lastB) {
+            i += 4;
+        }
+        if (lastB <= lastA) {
+            j += 4;
+        }
+    }
+    intersectMerge(a + i, n - i, b + j, m - j, out);
+}
+#endif
+
+} // namespace
+
+void intersectPostingsScalar(const std::vector<int>& a, const std::vector<int>& b, std::vector<int>& out) {
+    out.clear();
+    intersectMerge(a.data(), a.size(), b.data(), b.size(), out);
+}
+
+void intersectPostings(const std::vector<int>& a, const std::vector<int>& b, std::vector<int>& out) {
+    out.clear();
+    const std::vector<int>& small = a.size() <= b.size() ? a : b;
+    const std::vector<int>& large = a.size() <= b.size() ? b : a;
+    if (small.empty()) {
+        return;
+    }
+    out.reserve(small.size());
+    if (large.size() / small.size() >= GALLOP_RATIO) {
+        intersectGallop(small, large, out);
+        return;
+    }
+#ifdef POSTING_LISTS_SSE2
+    intersectSse2(small.data(), small.size(), large.data(), large.size(), out);
+#else
+    intersectMerge(small.data(), small.size(), large.data(), large.size(), out);
+#endif
+}
+
+void intersectPostings(const std::vector<const std::vector<int>*>& lists, std::vector<int>& out) {
+    out.clear();
+    if (lists.empty()) {
+        return;
+    }
+    std::vector<const std::vector<int>*> order(lists);
+    std::sort(order.begin(), order.end(), [](const std::vector<int>* a, const std::vector<int>* b) {
+        return a->size() < b->size();
+    });
+    if (order.size() == 1) {
+        out = *order[0];
+        return;
+    }
+
+    intersectPostings(*order[0], *order[1], out);
+    std::vector<int> next;
+    for (size_t i = 2; i < order.size() && !out.empty(); ++i) {
+        intersectPostings(out, *order[i], next);
+        out.swap(next);
+    }
+}
+
+void unionPostings(const std::vector<const std::vector<int>*>& lists, std::vector<int>& out) {
+    out.clear();
+    // 堆中为(当前元素, 表下标)，每个表同时只有一个元素在堆中
+    typedef std::pair<int, size_t> Head;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heap;
+    std::vector<size_t> positions(lists.size(), 0);
+    size_t total = 0;
+    for (size_t i = 0; i < lists.size(); ++i) {
+        if (!lists[i]->empty()) {
+            heap.emplace((*lists[i])[0], i);
+            total += lists[i]->size();
+        }
+    }
+    out.reserve(total);
+
+    while (!heap.empty()) {
+        Head head = heap.top();
+        heap.pop();
+        if (out.empty() || out.back() != head.first) {
+            out.push_back(head.first);
+        }
+        const std::vector<int>& list = *lists[head.second];
+        size_t& pos = positions[head.second];
+        if (++pos < list.size()) {
+            heap.emplace(list[pos], head.second);
+        }
+    }
+}
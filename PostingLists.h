@@ -0,0 +1,19 @@
+#ifndef POSTING_LISTS_H
+#define POSTING_LISTS_H
+
+#include <cstddef>
+#include <vector>
+
+// 按ID升序、无重复的倒排表的集合运算，结果写入out（先清空），同样升序无重复。
+// 求交：长度相差悬殊时对长表倍增跳跃查找（galloping），开销约为 短表长度 × log(长表长度)；
+// 长度相近时在x86-64上用SSE2每次比较4×4个元素，其他平台逐个归并。
+// 多个表求交时从最短的表开始依次求交，中间结果只会越来越短。
+// 求并：用最小堆同时归并所有表，开销为 总长度 × log(表数)。
+void intersectPostings(const std::vector<int>& a, const std::vector<int>& b, std::vector<int>& out);
+void intersectPostings(const std::vector<const std::vector<int>*>& lists, std::vector<int>& out);
+void unionPostings(const std::vector<const std::vector<int>*>& lists, std::vector<int>& out);
+
+// 逐个归并的参考实现，tests/KernelCheck.cpp 用它校验SSE2和跳跃查找
+void intersectPostingsScalar(const std::vector<int>& a, const std::vector<int>& b, std::vector<int>& out);
+
+#endif // POSTING_LISTS_H
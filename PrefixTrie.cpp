@@ -0,0 +1,259 @@
+#include "PrefixTrie.h"
+#include "TextFold.h"
+#include <algorithm>
+#include <queue>
+#include <tuple>
+
+PrefixTrie::PrefixTrie() : entries(0) {
+    clear();
+}
+
+int PrefixTrie::newNode(const std::string& label, int parent) {
+    int index;
+    if (!freeNodes.empty()) {
+        index = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        index = static_cast<int>(nodes.size());
+        nodes.emplace_back();
+    }
+
+    Node& node = nodes[index];
+    node.label = label;
+    node.display.clear();
+    node.children.clear();
+    node.parent = parent;
+    node.count = 0;
+    node.best = 0;
+    return index;
+}
+
+void PrefixTrie::freeNode(int index) {
+    Node& node = nodes[index];
+    node.label.clear();
+    node.display.clear();
+    node.children.clear();
+    node.parent = -1;
+    freeNodes.push_back(index);
+}
+
+int PrefixTrie::findChild(int index, unsigned char first) const {
+    // 子结点按首字节有序，且首字节互不相同
+    const std::vector<int>& children = nodes[index].children;
+    auto it = std::lower_bound(children.begin(), children.end(), first, [this](int child, unsigned char c) {
+        return static_cast<unsigned char>(nodes[child].label[0]) < c;
+    });
+    if (it != children.end() && static_cast<unsigned char>(nodes[*it].label[0]) == first) {
+        return *it;
+    }
+    return -1;
+}
+
+void PrefixTrie::addChild(int parent, int child) {
+    std::vector<int>& children = nodes[parent].children;
+    unsigned char first = static_cast<unsigned char>(nodes[child].label[0]);
+    auto it = std::lower_bound(children.begin(), children.end(), first, [this](int other, unsigned char c) {
+        return static_cast<unsigned char>(nodes[other].label[0]) < c;
+    });
+    children.insert(it, child);
+    nodes[child].parent = parent;
+}
+
+void PrefixTrie::removeChild(int parent, int child) {
+    std::vector<int>& children = nodes[parent].children;
+    children.erase(std::find(children.begin(), children.end(), child));
+}
+
+// 不是词条且只有一个子结点的结点与子结点合并，保持树的压缩形态
+bool PrefixTrie::mergeWithChild(int index) {
+    Node& node = nodes[index];
+    if (index == 0 || node.count > 0 || node.children.size() != 1) {
+        return false;
+    }
+
+    int child = node.children[0];
+    int parent = node.parent;
+    nodes[child].label = node.label + nodes[child].label;
+    removeChild(parent, index);
+    freeNode(index);
+    addChild(parent, child);
+    return true;
+}
+
+void PrefixTrie::updateBest(int index) {
+    while (index >= 0) {
+        Node& node = nodes[index];
+        int best = node.count;
+        for (int child : node.children) {
+            best = std::max(best, nodes[child].best);
+        }
+        if (best == node.best && index != 0) {
+            // 子树最大值没有变化，祖先也不会变
+            node.best = best;
+            return;
+        }
+        node.best = best;
+        index = node.parent;
+    }
+}
+
+int PrefixTrie::findExact(const std::string& key) const {
+    int index = 0;
+    size_t i = 0;
+    while (i < key.size()) {
+        int child = findChild(index, static_cast<unsigned char>(key[i]));
+        if (child == -1) {
+            return -1;
+        }
+        const std::string& label = nodes[child].label;
+        if (key.compare(i, label.size(), label) != 0) {
+            return -1;
+        }
+        i += label.size();
+        index = child;
+    }
+    return index;
+}
+
+void PrefixTrie::insert(const std::string& text, int weight) {
+    std::string key = foldText(text);
+    if (key.empty() || weight <= 0) {
+        return;
+    }
+
+    int index = 0;
+    size_t i = 0;
+    while (i < key.size()) {
+        int child = findChild(index, static_cast<unsigned char>(key[i]));
+        if (child == -1) {
+            int leaf = newNode(key.substr(i), index);
+            addChild(index, leaf);
+            index = leaf;
+            break;
+        }
+
+        const std::string& label = nodes[child].label;
+        size_t common = 0;
+        while (common < label.size() && i + common < key.size() && label[common] == key[i + common]) {
+            ++common;
+        }
+        if (common < label.size()) {
+            // 在边的中间分裂出一个结点
+            int middle = newNode(label.substr(0, common), index);
+            removeChild(index, child);
+            nodes[child].label.erase(0, common);
+            addChild(index, middle);
+            addChild(middle, child);
+            nodes[middle].best = nodes[child].best;
+            child = middle;
+        }
+        index = child;
+        i += common;
+    }
+
+    Node& node = nodes[index];
+    if (node.count == 0) {
+        node.display = text;
+        ++entries;
+    }
+    node.count += weight;
+    updateBest(index);
+}
+
+void PrefixTrie::remove(const std::string& text, int weight) {
+    int index = findExact(foldText(text));
+    if (index <= 0 || nodes[index].count == 0) {
+        return;
+    }
+
+    Node& node = nodes[index];
+    node.count -= weight;
+    if (node.count > 0) {
+        updateBest(index);
+        return;
+    }
+
+    node.count = 0;
+    node.display.clear();
+    --entries;
+
+    int parent = node.parent;
+    if (!node.children.empty()) {
+        // 仍有子结点：只有一个时与之合并
+        updateBest(mergeWithChild(index) ? parent : index);
+        return;
+    }
+
+    removeChild(parent, index);
+    freeNode(index);
+    int grandparent = nodes[parent].parent;
+    updateBest(mergeWithChild(parent) ? grandparent : parent);
+}
+
+void PrefixTrie::clear() {
+    nodes.clear();
+    freeNodes.clear();
+    entries = 0;
+    newNode("", -1);
+}
+
+std::vector<std::pair<std::string, int>> PrefixTrie::complete(const std::string& prefix, size_t k) const {
+    std::vector<std::pair<std::string, int>> results;
+    std::string key = foldText(prefix);
+
+    // 找到前缀结束处所在的结点（前缀可以停在一条边的中间）
+    int index = 0;
+    size_t i = 0;
+    std::string path;
+    while (i < key.size()) {
+        int child = findChild(index, static_cast<unsigned char>(key[i]));
+        if (child == -1) {
+            return results;
+        }
+        const std::string& label = nodes[child].label;
+        size_t length = std::min(label.size(), key.size() - i);
+        if (label.compare(0, length, key, i, length) != 0) {
+            return results;
+        }
+        path += label;
+        i += length;
+        index = child;
+    }
+
+    // 按(次数降序, 键升序)优先展开；键相同时词条本身排在子树之前
+    typedef std::tuple<int, std::string, bool, int> Entry;   // 次数, 键, 是否为词条, 结点
+    auto later = [](const Entry& a, const Entry& b) {
+        if (std::get<0>(a) != std::get<0>(b)) {
+            return std::get<0>(a) < std::get<0>(b);
+        }
+        if (std::get<1>(a) != std::get<1>(b)) {
+            return std::get<1>(a) > std::get<1>(b);
+        }
+        return !std::get<2>(a) && std::get<2>(b);
+    };
+    std::priority_queue<Entry, std::vector<Entry>, decltype(later)> queue(later);
+    if (nodes[index].best > 0) {
+        queue.emplace(nodes[index].best, path, false, index);
+    }
+
+    while (!queue.empty() && results.size() < k) {
+        Entry entry = queue.top();
+        queue.pop();
+        const Node& node = nodes[std::get<3>(entry)];
+        if (std::get<2>(entry)) {
+            results.emplace_back(node.display, node.count);
+            continue;
+        }
+        if (node.count > 0) {
+            queue.emplace(node.count, std::get<1>(entry), true, std::get<3>(entry));
+        }
+        for (int child : node.children) {
+            queue.emplace(nodes[child].best, std::get<1>(entry) + nodes[child].label, false, child);
+        }
+    }
+    return results;
+}
+
+size_t PrefixTrie::size() const {
+    return entries;
+}
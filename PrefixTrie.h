@@ -0,0 +1,50 @@
+#ifndef PREFIX_TRIE_H
+#define PREFIX_TRIE_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 前缀补全用的压缩字典树（基数树）。
+// 键是foldText规范化后的文本，按字节比较；每个键记一个次数（如同名书目数），
+// 每个结点记录子树中最大的次数，补全时按次数从大到小优先展开，
+// 取前k个只访问与结果相关的少量结点，与词条总数无关。
+// 插入、删除都只修改一条路径，可以随增删记录增量维护。
+class PrefixTrie {
+private:
+    struct Node {
+        std::string label;          // 从父结点到本结点的边上的字节串
+        std::string display;        // 以本结点结尾的词条的原文（用于显示）
+        std::vector<int> children;  // 按边的首字节升序
+        int parent;
+        int count;                  // 以本结点结尾的词条次数，0表示不是词条
+        int best;                   // 子树中最大的词条次数
+    };
+
+    std::vector<Node> nodes;        // 0号为根
+    std::vector<int> freeNodes;     // 已删除、可复用的结点
+    size_t entries;
+
+    int newNode(const std::string& label, int parent);
+    void freeNode(int index);
+    int findChild(int index, unsigned char first) const;
+    void addChild(int parent, int child);
+    void removeChild(int parent, int child);
+    bool mergeWithChild(int index);
+    void updateBest(int index);
+    int findExact(const std::string& key) const;
+
+public:
+    PrefixTrie();
+
+    void insert(const std::string& text, int weight = 1);
+    void remove(const std::string& text, int weight = 1);
+    void clear();
+
+    // 以prefix开头的词条中次数最多的k个：(原文, 次数)，次数相同时按字典序
+    std::vector<std::pair<std::string, int>> complete(const std::string& prefix, size_t k) const;
+    size_t size() const;
+};
+
+#endif // PREFIX_TRIE_H
@@ -0,0 +1,95 @@
+#include "QueryCache.h"
+#include <algorithm>
+
+QueryCache::QueryCache(size_t capacity, size_t maxResults)
+    : capacity(capacity), maxResults(maxResults), totalResults(0), hits(0), misses(0) {}
+
+std::string QueryCache::makeKey(const std::string& keyword, int filter) {
+    return std::to_string(filter) + '\x1f' + keyword;
+}
+
+void QueryCache::evict(Position position) {
+    for (int titleId : position->titleIds) {
+        auto it = byTitle.find(titleId);
+        if (it == byTitle.end()) {
+            continue;
+        }
+        std::vector<Position>& list = it->second;
+        list.erase(std::find(list.begin(), list.end(), position));
+        if (list.empty()) {
+            byTitle.erase(it);
+        }
+    }
+    totalResults -= position->results.size();
+    index.erase(makeKey(position->keyword, position->filter));
+    entries.erase(position);
+}
+
+const std::vector<int>* QueryCache::find(const std::string& keyword, int filter) {
+    auto it = index.find(makeKey(keyword, filter));
+    if (it == index.end()) {
+        ++misses;
+        return nullptr;
+    }
+    ++hits;
+    entries.splice(entries.begin(), entries, it->second);
+    return &it->second->results;
+}
+
+void QueryCache::insert(const std::string& keyword, int filter, const std::vector<int>& results,
+                        const std::vector<int>& titleIds) {
+    // 结果太多的查询不缓存，免得挤掉其他所有缓存项
+    if (capacity == 0 || results.size() > maxResults / 4) {
+        return;
+    }
+
+    std::string key = makeKey(keyword, filter);
+    auto existing = index.find(key);
+    if (existing != index.end()) {
+        evict(existing->second);
+    }
+
+    entries.push_front(Entry{keyword, filter, results, titleIds});
+    index[key] = entries.begin();
+    for (int titleId : titleIds) {
+        byTitle[titleId].push_back(entries.begin());
+    }
+    totalResults += results.size();
+
+    while (entries.size() > capacity || totalResults > maxResults) {
+        evict(std::prev(entries.end()));
+    }
+}
+
+void QueryCache::invalidateTitle(int titleId, bool loansOnly) {
+    auto it = byTitle.find(titleId);
+    if (it == byTitle.end()) {
+        return;
+    }
+    // evict会修改这个列表，先复制一份
+    std::vector<Position> positions = it->second;
+    for (Position position : positions) {
+        if (!loansOnly || position->filter != 0) {
+            evict(position);
+        }
+    }
+}
+
+void QueryCache::clear() {
+    entries.clear();
+    index.clear();
+    byTitle.clear();
+    totalResults = 0;
+}
+
+size_t QueryCache::size() const {
+    return entries.size();
+}
+
+size_t QueryCache::getHits() const {
+    return hits;
+}
+
+size_t QueryCache::getMisses() const {
+    return misses;
+}
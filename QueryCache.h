@@ -0,0 +1,67 @@
+#ifndef QUERY_CACHE_H
+#define QUERY_CACHE_H
+
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 查询结果缓存（LRU）。键是规范化后的关键字加筛选条件，值是按ID升序的结果，
+// 同时记下结果涉及的书目，建立书目 -> 缓存项的反向索引：
+// 某个书目的图书增删或借还时，只淘汰包含该书目的缓存项；
+// 新增书目时只淘汰关键字能匹配到新书目的缓存项。
+class QueryCache {
+public:
+    struct Entry {
+        std::string keyword;          // 规范化后的关键字
+        int filter;                   // 筛选条件，0表示与借阅状态无关
+        std::vector<int> results;     // 按ID升序
+        std::vector<int> titleIds;    // 结果涉及的书目
+    };
+
+private:
+    typedef std::list<Entry>::iterator Position;
+
+    std::list<Entry> entries;                                      // 最近使用的在前
+    std::unordered_map<std::string, Position> index;               // 键 -> 缓存项
+    std::unordered_map<int, std::vector<Position>> byTitle;        // 书目ID -> 包含它的缓存项
+    size_t capacity;
+    size_t maxResults;            // 所有缓存项的结果总数上限
+    size_t totalResults;
+    size_t hits;
+    size_t misses;
+
+    static std::string makeKey(const std::string& keyword, int filter);
+    void evict(Position position);
+
+public:
+    explicit QueryCache(size_t capacity = 64, size_t maxResults = 1 << 20);
+
+    // 命中时返回结果并移到最前，未命中返回nullptr；同时计入命中率
+    const std::vector<int>* find(const std::string& keyword, int filter);
+    void insert(const std::string& keyword, int filter, const std::vector<int>& results,
+                const std::vector<int>& titleIds);
+
+    // 淘汰包含该书目的缓存项；loansOnly为true时只淘汰与借阅状态有关的（filter不为0的）项
+    void invalidateTitle(int titleId, bool loansOnly);
+    // 淘汰满足条件的缓存项，pred以缓存项为参数
+    template <typename Pred>
+    void invalidateIf(Pred pred) {
+        for (Position it = entries.begin(); it != entries.end(); ) {
+            Position next = std::next(it);
+            if (pred(*it)) {
+                evict(it);
+            }
+            it = next;
+        }
+    }
+    void clear();
+
+    size_t size() const;
+    size_t getHits() const;
+    size_t getMisses() const;
+};
+
+#endif // QUERY_CACHE_H
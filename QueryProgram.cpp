@@ -0,0 +1,379 @@
+#include "QueryProgram.h"
+#include "TextFold.h"
+#include <algorithm>
+#include <sstream>
+
+struct QueryProgram::Token {
+    enum Kind {
+        WORD,
+        LEFT,
+        RIGHT,
+        END
+    };
+
+    Kind kind;
+    std::string text;
+    size_t colon;        // 第一个不在引号内的冒号的位置，没有时为npos
+    bool quoted;         // 含有引号，不再当作关键字或标志
+};
+
+namespace {
+
+const size_t MAX_NESTING = 64;
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// 全角冒号：U+FF1A，UTF-8为EF BC 9A
+bool isFullWidthColon(const std::string& text, size_t pos) {
+    return pos + 2 < text.size() && static_cast<unsigned char>(text[pos]) == 0xEF &&
+           static_cast<unsigned char>(text[pos + 1]) == 0xBC && static_cast<unsigned char>(text[pos + 2]) == 0x9A;
+}
+
+std::string upper(const std::string& text) {
+    std::string result = text;
+    for (char& c : result) {
+        if (c >= 'a' && c <= 'z') {
+            c = static_cast<char>(c - 'a' + 'A');
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+class QueryProgram::Parser {
+private:
+    std::vector<Token> tokens;
+    size_t pos;
+    QueryProgram& program;
+    Target target;
+    std::string& error;
+    size_t depth;        // 当前求值栈深度
+    size_t maxDepth;
+    size_t nesting;      // 括号和NOT的嵌套层数
+
+    bool isKeyword(const Token& token, const char* keyword) const {
+        return token.kind == Token::WORD && !token.quoted && upper(token.text) == keyword;
+    }
+
+    const Token& peek() const {
+        return tokens[pos];
+    }
+
+    void emit(OpCode op, Field field = FIELD_ALL, int operand = 0) {
+        program.code.push_back({op, field, operand});
+        if (op == OP_AND || op == OP_OR) {
+            --depth;
+        } else if (op != OP_NOT) {
+            maxDepth = std::max(maxDepth, ++depth);
+        }
+    }
+
+    bool lookupField(const std::string& name, Field& field) const {
+        std::string key = upper(name);
+        if (target == QUERY_BOOKS) {
+            if (key == "NAME" || name == "书名") {
+                field = FIELD_NAME;
+            } else if (key == "AUTHOR" || name == "作者") {
+                field = FIELD_AUTHOR;
+            } else if (key == "PUBLISHER" || name == "出版社") {
+                field = FIELD_PUBLISHER;
+            } else {
+                return false;
+            }
+        } else {
+            if (key == "NAME" || name == "姓名") {
+                field = FIELD_NAME;
+            } else if (key == "CONTACT" || name == "联系方式") {
+                field = FIELD_CONTACT;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool parseCondition(const Token& token, std::vector<size_t>& conjuncts) {
+        conjuncts.assign(1, program.code.size());
+
+        if (token.colon == std::string::npos) {
+            std::string key = upper(token.text);
+            if (target == QUERY_BOOKS && !token.quoted) {
+                if (key == "AVAILABLE" || token.text == "可借") {
+                    emit(OP_AVAILABLE);
+                    return true;
+                }
+                if (key == "BORROWED" || token.text == "已借出") {
+                    emit(OP_BORROWED);
+                    return true;
+                }
+            }
+            program.constants.push_back(foldText(token.text));
+            emit(OP_MATCH, FIELD_ALL, static_cast<int>(program.constants.size() - 1));
+            return true;
+        }
+
+        std::string name = token.text.substr(0, token.colon);
+        std::string value = token.text.substr(token.colon + 1);
+        if (value.empty()) {
+            error = "条件 " + token.text + " 缺少值";
+            return false;
+        }
+
+        if (upper(name) == "ID") {
+            int id = 0;
+            for (char c : value) {
+                if (c < '0' || c > '9' || id > 100000000) {
+                    error = "ID必须是正整数：" + value;
+                    return false;
+                }
+                id = id * 10 + (c - '0');
+            }
+            emit(OP_ID, FIELD_ALL, id);
+            return true;
+        }
+
+        Field field;
+        if (!lookupField(name, field)) {
+            error = "未知的字段：" + name;
+            return false;
+        }
+        program.constants.push_back(foldText(value));
+        emit(OP_MATCH, field, static_cast<int>(program.constants.size() - 1));
+        return true;
+    }
+
+    bool parseFactor(std::vector<size_t>& conjuncts) {
+        if (++nesting > MAX_NESTING) {
+            error = "查询嵌套过深";
+            return false;
+        }
+
+        bool ok;
+        const Token& token = peek();
+        if (isKeyword(token, "NOT")) {
+            ++pos;
+            std::vector<size_t> ignored;
+            ok = parseFactor(ignored);
+            if (ok) {
+                emit(OP_NOT);
+            }
+            conjuncts.clear();
+        } else if (token.kind == Token::LEFT) {
+            ++pos;
+            ok = parseExpression(conjuncts);
+            if (ok && peek().kind != Token::RIGHT) {
+                error = "缺少右括号";
+                ok = false;
+            }
+            ++pos;
+        } else if (token.kind == Token::WORD && !isKeyword(token, "AND") && !isKeyword(token, "OR")) {
+            ++pos;
+            ok = parseCondition(token, conjuncts);
+        } else {
+            error = token.kind == Token::END ? "查询不完整" : "此处应为条件：" + token.text;
+            ok = false;
+        }
+
+        --nesting;
+        return ok;
+    }
+
+    bool parseTerm(std::vector<size_t>& conjuncts) {
+        if (!parseFactor(conjuncts)) {
+            return false;
+        }
+        while (true) {
+            const Token& token = peek();
+            if (token.kind == Token::END || token.kind == Token::RIGHT || isKeyword(token, "OR")) {
+                return true;
+            }
+            if (isKeyword(token, "AND")) {
+                ++pos;
+            }
+            std::vector<size_t> more;
+            if (!parseFactor(more)) {
+                return false;
+            }
+            emit(OP_AND);
+            conjuncts.insert(conjuncts.end(), more.begin(), more.end());
+        }
+    }
+
+    bool parseExpression(std::vector<size_t>& conjuncts) {
+        if (!parseTerm(conjuncts)) {
+            return false;
+        }
+        while (isKeyword(peek(), "OR")) {
+            ++pos;
+            std::vector<size_t> ignored;
+            if (!parseTerm(ignored)) {
+                return false;
+            }
+            emit(OP_OR);
+            conjuncts.clear();
+        }
+        return true;
+    }
+
+    bool tokenize(const std::string& query) {
+        size_t i = 0;
+        while (i < query.size()) {
+            char c = query[i];
+            if (isSpace(c)) {
+                ++i;
+                continue;
+            }
+            if (c == '(' || c == ')') {
+                tokens.push_back({c == '(' ? Token::LEFT : Token::RIGHT, std::string(1, c), std::string::npos, false});
+                ++i;
+                continue;
+            }
+
+            Token token = {Token::WORD, "", std::string::npos, false};
+            bool inQuote = false;
+            while (i < query.size()) {
+                c = query[i];
+                if (c == '"') {
+                    inQuote = !inQuote;
+                    token.quoted = true;
+                    ++i;
+                    continue;
+                }
+                if (!inQuote && (isSpace(c) || c == '(' || c == ')')) {
+                    break;
+                }
+                if (!inQuote && token.colon == std::string::npos) {
+                    if (c == ':') {
+                        token.colon = token.text.size();
+                    } else if (isFullWidthColon(query, i)) {
+                        token.colon = token.text.size();
+                        token.text += ':';
+                        i += 3;
+                        continue;
+                    }
+                }
+                token.text += c;
+                ++i;
+            }
+            if (inQuote) {
+                error = "引号不配对";
+                return false;
+            }
+            tokens.push_back(token);
+        }
+        tokens.push_back({Token::END, "", std::string::npos, false});
+        return true;
+    }
+
+public:
+    Parser(QueryProgram& program, Target target, std::string& error)
+        : pos(0), program(program), target(target), error(error), depth(0), maxDepth(0), nesting(0) {}
+
+    bool parse(const std::string& query) {
+        if (!tokenize(query)) {
+            return false;
+        }
+        if (isKeyword(peek(), "EXPLAIN")) {
+            program.explain = true;
+            ++pos;
+        }
+        if (peek().kind == Token::END) {
+            error = "查询为空";
+            return false;
+        }
+        if (!parseExpression(program.conjuncts)) {
+            return false;
+        }
+        if (peek().kind != Token::END) {
+            error = "多余的内容：" + peek().text;
+            return false;
+        }
+        if (maxDepth > MAX_DEPTH) {
+            error = "查询过于复杂";
+            return false;
+        }
+        return true;
+    }
+};
+
+QueryProgram::QueryProgram() : explain(false) {}
+
+bool QueryProgram::compile(const std::string& query, Target target, std::string& error) {
+    code.clear();
+    constants.clear();
+    conjuncts.clear();
+    explain = false;
+    Parser parser(*this, target, error);
+    if (!parser.parse(query)) {
+        code.clear();
+        return false;
+    }
+    return true;
+}
+
+const std::vector<QueryProgram::Instruction>& QueryProgram::getCode() const {
+    return code;
+}
+
+const std::string& QueryProgram::getConstant(int index) const {
+    return constants[index];
+}
+
+const std::vector<size_t>& QueryProgram::getConjuncts() const {
+    return conjuncts;
+}
+
+bool QueryProgram::isExplain() const {
+    return explain;
+}
+
+const char* QueryProgram::fieldName(Field field) {
+    switch (field) {
+        case FIELD_NAME:
+            return "name";
+        case FIELD_AUTHOR:
+            return "author";
+        case FIELD_PUBLISHER:
+            return "publisher";
+        case FIELD_CONTACT:
+            return "contact";
+        default:
+            return "*";
+    }
+}
+
+std::string QueryProgram::disassemble() const {
+    std::ostringstream out;
+    for (size_t i = 0; i < code.size(); ++i) {
+        const Instruction& instruction = code[i];
+        out << "  " << i << "  ";
+        switch (instruction.op) {
+            case OP_MATCH:
+                out << "MATCH " << fieldName(instruction.field) << " \"" << constants[instruction.operand] << "\"";
+                break;
+            case OP_ID:
+                out << "ID " << instruction.operand;
+                break;
+            case OP_AVAILABLE:
+                out << "AVAILABLE";
+                break;
+            case OP_BORROWED:
+                out << "BORROWED";
+                break;
+            case OP_AND:
+                out << "AND";
+                break;
+            case OP_OR:
+                out << "OR";
+                break;
+            case OP_NOT:
+                out << "NOT";
+                break;
+        }
+        out << "\n";
+    }
+    return out.str();
+}
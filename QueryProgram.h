@@ -0,0 +1,109 @@
+#ifndef QUERY_PROGRAM_H
+#define QUERY_PROGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 条件查询语言，编译为后缀形式的谓词程序。
+// 语法：
+//   表达式 := 项 { OR 项 }
+//   项     := 因子 { [AND] 因子 }       相邻两个条件之间省略AND时按AND处理
+//   因子   := NOT 因子 | ( 表达式 ) | 条件
+//   条件   := 字段:值 | 标志 | 值          只写值时在所有文本字段中查找
+// 图书字段：name/书名、author/作者、publisher/出版社、id；标志：available/可借、borrowed/已借出
+// 读者字段：name/姓名、contact/联系方式、id
+// 值中有空格、括号或冒号时用双引号括起来；AND、OR、NOT不区分大小写。
+// 整个查询前加EXPLAIN时，执行的同时输出程序和所选的执行计划。
+//
+// 程序一次对一批（至多64条）记录求值：栈上每个单元是一个64位掩码，
+// 条件指令的结果由调用方给出（通常是事先求好的条件位图中的一个字），AND/OR/NOT整字运算，
+// 指令分派的开销由64条记录分摊。
+class QueryProgram {
+public:
+    enum Target {
+        QUERY_BOOKS,
+        QUERY_READERS
+    };
+
+    enum OpCode {
+        OP_MATCH,        // 字段包含常量（已foldText规范化）
+        OP_ID,           // ID等于operand
+        OP_AVAILABLE,    // 可借
+        OP_BORROWED,     // 已借出
+        OP_AND,
+        OP_OR,
+        OP_NOT
+    };
+
+    enum Field {
+        FIELD_ALL,       // 所有文本字段
+        FIELD_NAME,
+        FIELD_AUTHOR,
+        FIELD_PUBLISHER,
+        FIELD_CONTACT
+    };
+
+    struct Instruction {
+        OpCode op;
+        Field field;
+        int operand;     // OP_MATCH为常量下标，OP_ID为ID
+    };
+
+    static const size_t MAX_DEPTH = 32;   // 求值栈的深度上限
+
+private:
+    struct Token;
+    class Parser;
+
+    std::vector<Instruction> code;
+    std::vector<std::string> constants;
+    std::vector<size_t> conjuncts;       // 从根一路经AND可达的条件指令
+    bool explain;
+
+public:
+    QueryProgram();
+
+    // 编译失败时返回false，error为原因
+    bool compile(const std::string& query, Target target, std::string& error);
+
+    const std::vector<Instruction>& getCode() const;
+    const std::string& getConstant(int index) const;
+    // 这些条件必须全部成立，执行计划可以先用索引单独求出它们的交集作为候选
+    const std::vector<size_t>& getConjuncts() const;
+    bool isExplain() const;
+
+    // 对一批记录求值。lanes中为1的位是需要求值的记录，
+    // leaf(指令, lanes)返回lanes中满足该条件的记录；结果总是lanes的子集
+    template <typename Leaf>
+    std::uint64_t run(std::uint64_t lanes, Leaf leaf) const {
+        std::uint64_t stack[MAX_DEPTH];
+        size_t top = 0;
+        for (const Instruction& instruction : code) {
+            switch (instruction.op) {
+                case OP_AND:
+                    --top;
+                    stack[top - 1] &= stack[top];
+                    break;
+                case OP_OR:
+                    --top;
+                    stack[top - 1] |= stack[top];
+                    break;
+                case OP_NOT:
+                    stack[top - 1] = ~stack[top - 1] & lanes;
+                    break;
+                default:
+                    stack[top++] = leaf(instruction, lanes);
+                    break;
+            }
+        }
+        return top == 1 ? stack[0] & lanes : 0;
+    }
+
+    // 每条指令一行的程序清单
+    std::string disassemble() const;
+    static const char* fieldName(Field field);
+};
+
+#endif // QUERY_PROGRAM_H
@@ -1,27 +1,31 @@
 #include "Reader.h"
 #include <algorithm>
 
-Reader::Reader() : id(0) {}
+Reader::Reader() : id(0), loanLimit(DEFAULT_LOAN_LIMIT) {}
 
 Reader::Reader(int id, const std::string& name, const std::string& contact)
-    : id(id), name(name), contact(contact) {}
+    : id(id), loanLimit(DEFAULT_LOAN_LIMIT), name(name), contact(contact) {}
 
 int Reader::getId() const {
     return id;
 }
 
-std::string Reader::getName() const {
+const std::string& Reader::getName() const {
     return name;
 }
 
-std::string Reader::getContact() const {
+const std::string& Reader::getContact() const {
     return contact;
 }
 
-const std::vector<int>& Reader::getBorrowedBooks() const {
+const Reader::BookList& Reader::getBorrowedBooks() const {
     return borrowedBooks;
 }
 
+int Reader::getLoanLimit() const {
+    return loanLimit;
+}
+
 void Reader::setId(int id) {
     this->id = id;
 }
@@ -34,8 +38,24 @@ void Reader::setContact(const std::string& contact) {
     this->contact = contact;
 }
 
+bool Reader::setLoanLimit(int limit) {
+    if (limit <= 0) {
+        return false;
+    }
+    loanLimit = limit;
+    return true;
+}
+
+bool Reader::canBorrow() const {
+    return borrowedBooks.size() < static_cast<size_t>(loanLimit);
+}
+
 bool Reader::borrowBook(int bookId) {
-    // 检查是否已经借了这本书
+    if (!canBorrow()) {
+        return false; // 已达到借阅上限
+    }
+    
+    // 检查是否已经借了这本书（已借数量不超过上限，查找代价有界）
     if (std::find(borrowedBooks.begin(), borrowedBooks.end(), bookId) != borrowedBooks.end()) {
         return false; // 已经借了这本书
     }
@@ -54,11 +74,21 @@ bool Reader::returnBook(int bookId) {
     return true;
 }
 
+void Reader::setBorrowedBooks(const std::vector<int>& bookIds) {
+    borrowedBooks.clear();
+    borrowedBooks.reserve(bookIds.size());
+    for (int bookId : bookIds) {
+        if (std::find(borrowedBooks.begin(), borrowedBooks.end(), bookId) == borrowedBooks.end()) {
+            borrowedBooks.push_back(bookId);
+        }
+    }
+}
+
 void Reader::display() const {
     std::cout << "读者ID: " << id << std::endl;
     std::cout << "姓名: " << name << std::endl;
     std::cout << "联系方式: " << contact << std::endl;
-    std::cout << "已借图书数量: " << borrowedBooks.size() << std::endl;
+    std::cout << "已借图书数量: " << borrowedBooks.size() << " / " << loanLimit << std::endl;
     
     if (!borrowedBooks.empty()) {
         std::cout << "已借图书ID: ";
@@ -75,8 +105,12 @@ void Reader::display() const {
 std::ostream& operator<<(std::ostream& os, const Reader& reader) {
     os << reader.id << "\n" << reader.name << "\n" << reader.contact << "\n";
     
-    // 保存已借图书ID列表
-    os << reader.borrowedBooks.size() << "\n";
+    // 保存已借图书ID列表；借阅上限不是默认值时跟在数量后面
+    os << reader.borrowedBooks.size();
+    if (reader.loanLimit != Reader::DEFAULT_LOAN_LIMIT) {
+        os << " " << reader.loanLimit;
+    }
+    os << "\n";
     for (int bookId : reader.borrowedBooks) {
         os << bookId << " ";
     }
@@ -91,9 +125,18 @@ std::istream& operator>>(std::istream& is, Reader& reader) {
     std::getline(is, reader.contact);
     
     // 读取已借图书ID列表
-    size_t count;
-    is >> count;
+    size_t count = 0;
     reader.borrowedBooks.clear();
+    reader.loanLimit = Reader::DEFAULT_LOAN_LIMIT;
+    if (!(is >> count)) {
+        return is;
+    }
+    while (is.peek() == ' ' || is.peek() == '\t') {
+        is.get();
+    }
+    if (is.peek() != '\n' && is.peek() != '\r' && is.peek() != std::char_traits<char>::eof()) {
+        is >> reader.loanLimit;
+    }
     
     for (size_t i = 0; i < count; ++i) {
         int bookId;
@@ -4,13 +4,22 @@
 #include <string>
 #include <iostream>
 #include <vector>
+#include "SmallVector.h"
 
 class Reader {
+public:
+    static const int DEFAULT_LOAN_LIMIT = 10;   // 默认借阅上限
+    static const int INLINE_LOANS = 4;          // 对象内部能存放的已借图书数
+    // 已借图书ID列表：大多数读者同时只借几本书，不超过INLINE_LOANS时不分配堆内存，
+    // 且对象大小与std::vector<int>相同
+    typedef SmallVector<int, INLINE_LOANS> BookList;
+
 private:
     int id;                    // 读者ID
+    int loanLimit;             // 借阅上限
     std::string name;          // 读者姓名
     std::string contact;       // 联系方式
-    std::vector<int> borrowedBooks;  // 已借图书ID列表
+    BookList borrowedBooks;    // 已借图书ID列表
 
 public:
     Reader();
@@ -18,18 +27,23 @@ public:
     
     // 获取读者信息
     int getId() const;
-    std::string getName() const;
-    std::string getContact() const;
-    const std::vector<int>& getBorrowedBooks() const;
+    const std::string& getName() const;
+    const std::string& getContact() const;
+    const BookList& getBorrowedBooks() const;
+    int getLoanLimit() const;
     
     // 设置读者信息
     void setId(int id);
     void setName(const std::string& name);
     void setContact(const std::string& contact);
+    bool setLoanLimit(int limit);
     
     // 借书和还书
+    bool canBorrow() const;
     bool borrowBook(int bookId);
     bool returnBook(int bookId);
+    // 恢复已借图书列表（导入数据时使用，不检查借阅上限）
+    void setBorrowedBooks(const std::vector<int>& bookIds);
     
     // 显示读者信息
     void display() const;
@@ -37,6 +51,7 @@ public:
     // 文件读写辅助函数
     friend std::ostream& operator<<(std::ostream& os, const Reader& reader);
     friend std::istream& operator>>(std::istream& is, Reader& reader);
+    friend class RecordParser;
 };
 
 #endif // READER_H 
\ No newline at end of file
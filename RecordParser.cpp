@@ -0,0 +1,189 @@
+#include "RecordParser.h"
+#include <charconv>
+#include <cstring>
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+void trim(const char*& begin, const char*& end) {
+    while (begin < end && isSpace(*begin)) {
+        ++begin;
+    }
+    while (end > begin && isSpace(end[-1])) {
+        --end;
+    }
+}
+
+} // namespace
+
+RecordParser::RecordParser(const char* begin, const char* end, size_t firstLine)
+    : pos(begin), end(end), line(firstLine) {}
+
+bool RecordParser::nextLine(const char*& lineBegin, const char*& lineEnd) {
+    if (pos >= end) {
+        return false;
+    }
+    lineBegin = pos;
+    const char* newline = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+    if (newline) {
+        lineEnd = newline;
+        pos = newline + 1;
+    } else {
+        lineEnd = end;
+        pos = end;
+    }
+    // 兼容Windows换行
+    if (lineEnd > lineBegin && lineEnd[-1] == '\r') {
+        --lineEnd;
+    }
+    ++line;
+    return true;
+}
+
+bool RecordParser::fail(const char* message) {
+    error = message;
+    return false;
+}
+
+bool RecordParser::parseIntLine(int& value, const char* what) {
+    const char* b;
+    const char* e;
+    if (!nextLine(b, e)) {
+        ++line;
+        return fail("记录不完整");
+    }
+    trim(b, e);
+    auto result = std::from_chars(b, e, value);
+    if (result.ec != std::errc() || result.ptr != e) {
+        return fail(what);
+    }
+    return true;
+}
+
+bool RecordParser::atEnd() {
+    while (pos < end && isSpace(*pos)) {
+        if (*pos == '\n') {
+            ++line;
+        }
+        ++pos;
+    }
+    return pos >= end;
+}
+
+bool RecordParser::parse(Book& book) {
+    if (!parseIntLine(book.id, "图书ID不是有效的整数")) {
+        return false;
+    }
+
+    const char* b;
+    const char* e;
+    Title& title = *book.title;
+    std::string* fields[] = {&title.name, &title.author, &title.publisher};
+    for (std::string* field : fields) {
+        if (!nextLine(b, e)) {
+            ++line;
+            return fail("记录不完整");
+        }
+        field->assign(b, e);
+    }
+
+    if (!nextLine(b, e)) {
+        ++line;
+        return fail("记录不完整");
+    }
+    trim(b, e);
+    if (e - b != 1 || (*b != '0' && *b != '1')) {
+        return fail("借阅状态必须是0或1");
+    }
+    book.borrowed = (*b == '1');
+    return true;
+}
+
+bool RecordParser::parse(Reader& reader) {
+    if (!parseIntLine(reader.id, "读者ID不是有效的整数")) {
+        return false;
+    }
+
+    const char* b;
+    const char* e;
+    if (!nextLine(b, e)) {
+        ++line;
+        return fail("记录不完整");
+    }
+    reader.name.assign(b, e);
+    if (!nextLine(b, e)) {
+        ++line;
+        return fail("记录不完整");
+    }
+    reader.contact.assign(b, e);
+
+    // 数量行：已借图书数量，可选地跟一个借阅上限
+    if (!nextLine(b, e)) {
+        ++line;
+        return fail("记录不完整");
+    }
+    trim(b, e);
+    int count;
+    auto counted = std::from_chars(b, e, count);
+    if (counted.ec != std::errc()) {
+        return fail("已借图书数量不是有效的整数");
+    }
+    if (count < 0) {
+        return fail("已借图书数量不能为负数");
+    }
+    reader.loanLimit = Reader::DEFAULT_LOAN_LIMIT;
+    b = counted.ptr;
+    if (b != e) {
+        while (b < e && isSpace(*b)) {
+            ++b;
+        }
+        auto limited = std::from_chars(b, e, reader.loanLimit);
+        if (limited.ec != std::errc() || limited.ptr != e || reader.loanLimit <= 0) {
+            return fail("借阅上限不是有效的正整数");
+        }
+    }
+
+    // 已借图书ID在同一行，以空格分隔（数量为0时为空行）
+    if (!nextLine(b, e)) {
+        if (count > 0) {
+            ++line;
+            return fail("记录不完整");
+        }
+        b = e = end;
+    }
+    // 每个ID至少占一位数字加一个分隔符，先按行长检查数量再预留，损坏的数量不会造成巨大的分配
+    if (count > (e - b + 1) / 2) {
+        return fail("已借图书ID的个数与数量不符");
+    }
+    reader.borrowedBooks.clear();
+    reader.borrowedBooks.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        while (b < e && isSpace(*b)) {
+            ++b;
+        }
+        int bookId;
+        auto result = std::from_chars(b, e, bookId);
+        if (result.ec != std::errc()) {
+            return fail("已借图书ID不是有效的整数");
+        }
+        reader.borrowedBooks.push_back(bookId);
+        b = result.ptr;
+    }
+    trim(b, e);
+    if (b != e) {
+        return fail("已借图书ID的个数与数量不符");
+    }
+    return true;
+}
+
+size_t RecordParser::getLine() const {
+    // 出错时line已经越过出错的那一行
+    return line - 1;
+}
+
+const std::string& RecordParser::getError() const {
+    return error;
+}
@@ -0,0 +1,35 @@
+#ifndef RECORD_PARSER_H
+#define RECORD_PARSER_H
+
+#include <string>
+#include "Book.h"
+#include "Reader.h"
+
+// 直接在内存缓冲区上解析数据文件中的记录：
+// 用memchr切分行，用std::from_chars解析整数，不经过iostream和locale。
+// 出错时记录出错的行号和原因。
+class RecordParser {
+private:
+    const char* pos;
+    const char* end;
+    size_t line;             // 下一行的行号（从1开始）
+    std::string error;
+
+    bool nextLine(const char*& lineBegin, const char*& lineEnd);
+    bool parseIntLine(int& value, const char* what);
+    bool fail(const char* message);
+
+public:
+    // firstLine为begin所在的行号，用于分段解析时报告正确的行号
+    RecordParser(const char* begin, const char* end, size_t firstLine = 1);
+
+    // 剩余内容只有空白时视为结束
+    bool atEnd();
+    bool parse(Book& book);
+    bool parse(Reader& reader);
+
+    size_t getLine() const;
+    const std::string& getError() const;
+};
+
+#endif // RECORD_PARSER_H
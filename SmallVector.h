@@ -0,0 +1,137 @@
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// 带内联缓冲区的小数组：元素不超过N个时直接存放在对象内部，不分配堆内存，
+// 超过后才转到堆上。只用于int这类可以按字节复制的元素。
+template <typename T, size_t N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable<T>::value, "SmallVector只支持可按字节复制的类型");
+    static_assert(N > 0, "内联容量不能为0");
+
+private:
+    std::uint32_t count;
+    std::uint32_t capacity;     // 等于N时数据在内联缓冲区中
+    union {
+        T inlineData[N];
+        T* heapData;
+    };
+
+    bool onHeap() const { return capacity > N; }
+
+    void grow(size_t minCapacity) {
+        size_t newCapacity = capacity * 2 > minCapacity ? capacity * 2 : minCapacity;
+        T* newData = new T[newCapacity];
+        std::memcpy(newData, data(), count * sizeof(T));
+        release();
+        heapData = newData;
+        capacity = static_cast<std::uint32_t>(newCapacity);
+    }
+
+    void release() {
+        if (onHeap()) {
+            delete[] heapData;
+        }
+        capacity = N;
+    }
+
+    void copyFrom(const SmallVector& other) {
+        if (other.count > N) {
+            heapData = new T[other.count];
+            capacity = other.count;
+        }
+        std::memcpy(data(), other.data(), other.count * sizeof(T));
+        count = other.count;
+    }
+
+    void moveFrom(SmallVector& other) {
+        if (other.onHeap()) {
+            heapData = other.heapData;
+            capacity = other.capacity;
+            other.capacity = N;
+        } else {
+            std::memcpy(inlineData, other.inlineData, other.count * sizeof(T));
+        }
+        count = other.count;
+        other.count = 0;
+    }
+
+public:
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    SmallVector() : count(0), capacity(N) {}
+    SmallVector(const SmallVector& other) : count(0), capacity(N) { copyFrom(other); }
+    SmallVector(SmallVector&& other) noexcept : count(0), capacity(N) { moveFrom(other); }
+    ~SmallVector() { release(); }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            if (other.count <= capacity) {
+                std::memcpy(data(), other.data(), other.count * sizeof(T));
+                count = other.count;
+            } else {
+                release();
+                copyFrom(other);
+            }
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept {
+        if (this != &other) {
+            release();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    T* data() { return onHeap() ? heapData : inlineData; }
+    const T* data() const { return onHeap() ? heapData : inlineData; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    // 当前是否仍在内联缓冲区中（没有堆内存）
+    bool isInline() const { return !onHeap(); }
+
+    T& operator[](size_t i) { return data()[i]; }
+    const T& operator[](size_t i) const { return data()[i]; }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + count; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + count; }
+
+    void reserve(size_t n) {
+        if (n > capacity) {
+            grow(n);
+        }
+    }
+
+    void push_back(const T& value) {
+        if (count == capacity) {
+            T copy = value;     // value可能就在当前缓冲区中
+            grow(count + 1);
+            data()[count++] = copy;
+            return;
+        }
+        data()[count++] = value;
+    }
+
+    // 删除一个元素，保持其余元素的顺序
+    iterator erase(const_iterator pos) {
+        T* base = data();
+        size_t index = pos - base;
+        std::memmove(base + index, base + index + 1, (count - index - 1) * sizeof(T));
+        --count;
+        return base + index;
+    }
+
+    void clear() { count = 0; }
+};
+
+#endif // SMALL_VECTOR_H
@@ -0,0 +1,146 @@
+#include "SortedView.h"
+
+SortedView::SortedView() : level(1), count(0), seed(2463534242u) {
+    clear();
+}
+
+// 每升一层的概率为1/4
+int SortedView::randomLevel() {
+    int height = 1;
+    while (height < MAX_LEVEL) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        if ((seed & 3) != 0) {
+            break;
+        }
+        ++height;
+    }
+    return height;
+}
+
+int SortedView::newNode(const std::string& key, int id, int height) {
+    int index;
+    if (!freeNodes.empty()) {
+        index = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        index = static_cast<int>(nodes.size());
+        nodes.emplace_back();
+    }
+    Node& node = nodes[index];
+    node.key = key;
+    node.id = id;
+    node.links.assign(height, Link{0, 0});
+    return index;
+}
+
+bool SortedView::before(int index, const std::string& key, int id) const {
+    const Node& node = nodes[index];
+    int order = node.key.compare(key);
+    return order != 0 ? order < 0 : node.id < id;
+}
+
+void SortedView::insert(const std::string& key, int id) {
+    int update[MAX_LEVEL];
+    size_t rankAt[MAX_LEVEL];   // update[i]的名次（头结点为0）
+    int index = 0;
+    size_t rank = 0;
+    for (int i = level - 1; i >= 0; --i) {
+        while (nodes[index].links[i].next != 0 && before(nodes[index].links[i].next, key, id)) {
+            rank += nodes[index].links[i].width;
+            index = nodes[index].links[i].next;
+        }
+        update[i] = index;
+        rankAt[i] = rank;
+    }
+
+    int height = randomLevel();
+    for (; level < height; ++level) {
+        update[level] = 0;
+        rankAt[level] = 0;
+        nodes[0].links[level] = Link{0, count};
+    }
+
+    int created = newNode(key, id, height);
+    for (int i = 0; i < height; ++i) {
+        Link& link = nodes[update[i]].links[i];
+        nodes[created].links[i] = Link{link.next, link.width - (rank - rankAt[i])};
+        link.next = created;
+        link.width = rank - rankAt[i] + 1;
+    }
+    for (int i = height; i < level; ++i) {
+        ++nodes[update[i]].links[i].width;
+    }
+    ++count;
+}
+
+bool SortedView::erase(const std::string& key, int id) {
+    int update[MAX_LEVEL];
+    int index = 0;
+    for (int i = level - 1; i >= 0; --i) {
+        while (nodes[index].links[i].next != 0 && before(nodes[index].links[i].next, key, id)) {
+            index = nodes[index].links[i].next;
+        }
+        update[i] = index;
+    }
+
+    int target = nodes[index].links[0].next;
+    if (target == 0 || nodes[target].id != id || nodes[target].key != key) {
+        return false;
+    }
+
+    for (int i = 0; i < level; ++i) {
+        Link& link = nodes[update[i]].links[i];
+        if (link.next == target) {
+            link.width += nodes[target].links[i].width - 1;
+            link.next = nodes[target].links[i].next;
+        } else {
+            --link.width;
+        }
+    }
+    while (level > 1 && nodes[0].links[level - 1].next == 0) {
+        --level;
+    }
+
+    Node& node = nodes[target];
+    std::string().swap(node.key);
+    std::vector<Link>().swap(node.links);
+    freeNodes.push_back(target);
+    --count;
+    return true;
+}
+
+void SortedView::clear() {
+    nodes.assign(1, Node());
+    nodes[0].links.assign(MAX_LEVEL, Link{0, 0});
+    freeNodes.clear();
+    level = 1;
+    count = 0;
+}
+
+void SortedView::range(size_t rank, size_t limit, std::vector<int>& ids) const {
+    ids.clear();
+    if (rank >= count || limit == 0) {
+        return;
+    }
+
+    // 找名次为rank + 1的结点（头结点名次为0）
+    size_t target = rank + 1;
+    size_t traversed = 0;
+    int index = 0;
+    for (int i = level - 1; i >= 0; --i) {
+        while (nodes[index].links[i].next != 0 && traversed + nodes[index].links[i].width <= target) {
+            traversed += nodes[index].links[i].width;
+            index = nodes[index].links[i].next;
+        }
+    }
+
+    for (; index != 0 && ids.size() < limit; index = nodes[index].links[0].next) {
+        ids.push_back(nodes[index].id);
+    }
+}
+
+size_t SortedView::size() const {
+    return count;
+}
@@ -0,0 +1,59 @@
+#ifndef SORTED_VIEW_H
+#define SORTED_VIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 按排序键有序的记录视图（可按名次定位的跳表）。
+// 元素按(排序键, ID)排列，键相同时ID小的在前；每条前向指针记录它跨过的元素个数，
+// 因此插入、删除和取第r个元素都是O(log n)，取第r个起的一页再加上页长。
+// 顺序遍历只沿最底层指针前进，不需要排序
+class SortedView {
+private:
+    struct Link {
+        int next;            // 后继结点，0表示没有
+        size_t width;        // 到后继结点（没有时到末尾）跨过的元素个数
+    };
+
+    struct Node {
+        std::string key;
+        int id;
+        std::vector<Link> links;   // 第i层的前向指针
+    };
+
+    static const int MAX_LEVEL = 24;
+
+    std::vector<Node> nodes;       // 0号为头结点
+    std::vector<int> freeNodes;    // 已删除、可复用的结点
+    int level;                     // 当前使用的层数
+    size_t count;
+    std::uint32_t seed;            // 随机层数用的xorshift状态
+
+    int randomLevel();
+    int newNode(const std::string& key, int id, int height);
+    bool before(int index, const std::string& key, int id) const;
+
+public:
+    SortedView();
+
+    void insert(const std::string& key, int id);
+    // 删除(key, id)，不存在时返回false
+    bool erase(const std::string& key, int id);
+    void clear();
+
+    // 从第rank个（从0开始）起至多limit个元素的ID，依次写入ids（先清空）
+    void range(size_t rank, size_t limit, std::vector<int>& ids) const;
+    // 按顺序对每个ID调用visit
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        for (int index = nodes[0].links[0].next; index != 0; index = nodes[index].links[0].next) {
+            visit(nodes[index].id);
+        }
+    }
+
+    size_t size() const;
+};
+
+#endif // SORTED_VIEW_H
@@ -0,0 +1,236 @@
+#include "TextArena.h"
+#include "TextFold.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TEXT_ARENA_SSE2 1
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define TEXT_ARENA_AVX2 1
+#endif
+
+namespace {
+
+const char FIELD_SEPARATOR = '\x1f';
+const char RECORD_SEPARATOR = '\n';
+const size_t NOT_FOUND = static_cast<size_t>(-1);
+
+inline size_t lowestBit(unsigned mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return static_cast<size_t>(__builtin_ctz(mask));
+#endif
+}
+
+// 以下各函数返回from及之后关键字第一次出现的位置，没有时返回NOT_FOUND（要求k >= 1）
+size_t findScalar(const char* s, size_t n, const char* kw, size_t k, size_t from) {
+    for (size_t i = from; i + k <= n; ++i) {
+        const void* hit = std::memchr(s + i, kw[0], n - k + 1 - i);
+        if (!hit) {
+            return NOT_FOUND;
+        }
+        i = static_cast<const char*>(hit) - s;
+        if (std::memcmp(s + i + 1, kw + 1, k - 1) == 0) {
+            return i;
+        }
+    }
+    return NOT_FOUND;
+}
+
+#ifdef TEXT_ARENA_SSE2
+size_t findSse2(const char* s, size_t n, const char* kw, size_t k, size_t from) {
+    const __m128i first = _mm_set1_epi8(kw[0]);
+    const __m128i last = _mm_set1_epi8(kw[k - 1]);
+    size_t i = from;
+    for (; i + k - 1 + 16 <= n; i += 16) {
+        __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + k - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))));
+        while (mask != 0) {
+            size_t pos = i + lowestBit(mask);
+            if (k <= 2 || std::memcmp(s + pos + 1, kw + 1, k - 2) == 0) {
+                return pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return findScalar(s, n, kw, k, i);
+}
+#endif
+
+#ifdef TEXT_ARENA_AVX2
+__attribute__((target("avx2")))
+size_t findAvx2(const char* s, size_t n, const char* kw, size_t k, size_t from) {
+    const __m256i first = _mm256_set1_epi8(kw[0]);
+    const __m256i last = _mm256_set1_epi8(kw[k - 1]);
+    size_t i = from;
+    for (; i + k - 1 + 32 <= n; i += 32) {
+        __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i + k - 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last))));
+        while (mask != 0) {
+            size_t pos = i + lowestBit(mask);
+            if (k <= 2 || std::memcmp(s + pos + 1, kw + 1, k - 2) == 0) {
+                return pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return findScalar(s, n, kw, k, i);
+}
+#endif
+
+typedef size_t (*FindKernel)(const char*, size_t, const char*, size_t, size_t);
+
+FindKernel selectKernel() {
+#ifdef TEXT_ARENA_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return findAvx2;
+    }
+#endif
+#ifdef TEXT_ARENA_SSE2
+    return findSse2;
+#else
+    return findScalar;
+#endif
+}
+
+const FindKernel findKernel = selectKernel();
+
+} // namespace
+
+TextArena::TextArena() : deadBytes(0) {}
+
+size_t TextArena::recordAt(size_t offset) const {
+    return std::upper_bound(starts.begin(), starts.end(), offset) - starts.begin() - 1;
+}
+
+size_t TextArena::recordEnd(size_t record) const {
+    return record + 1 < starts.size() ? starts[record + 1] : text.size();
+}
+
+void TextArena::add(int ownerId, std::initializer_list<const std::string*> fields) {
+    remove(ownerId);
+
+    recordOf[ownerId] = owners.size();
+    starts.push_back(text.size());
+    owners.push_back(ownerId);
+    bool first = true;
+    for (const std::string* field : fields) {
+        if (!first) {
+            text += FIELD_SEPARATOR;
+        }
+        foldText(*field, buffer);
+        text += buffer;
+        first = false;
+    }
+    text += RECORD_SEPARATOR;
+}
+
+void TextArena::remove(int ownerId) {
+    auto it = recordOf.find(ownerId);
+    if (it == recordOf.end()) {
+        return;
+    }
+
+    size_t record = it->second;
+    recordOf.erase(it);
+    owners[record] = 0;
+    deadBytes += recordEnd(record) - starts[record];
+    compactIfNeeded();
+}
+
+// 空洞超过一半时按原顺序重建，均摊到每次删除为O(1)
+void TextArena::compactIfNeeded() {
+    if (deadBytes < 4096 || deadBytes * 2 < text.size()) {
+        return;
+    }
+
+    std::string packed;
+    packed.reserve(text.size() - deadBytes);
+    std::vector<size_t> packedStarts;
+    std::vector<int> packedOwners;
+    recordOf.clear();
+    for (size_t record = 0; record < owners.size(); ++record) {
+        if (owners[record] == 0) {
+            continue;
+        }
+        recordOf[owners[record]] = packedOwners.size();
+        packedStarts.push_back(packed.size());
+        packedOwners.push_back(owners[record]);
+        packed.append(text, starts[record], recordEnd(record) - starts[record]);
+    }
+
+    text.swap(packed);
+    starts.swap(packedStarts);
+    owners.swap(packedOwners);
+    deadBytes = 0;
+}
+
+void TextArena::clear() {
+    text.clear();
+    starts.clear();
+    owners.clear();
+    recordOf.clear();
+    deadBytes = 0;
+}
+
+void TextArena::reserve(size_t bytes, size_t records) {
+    text.reserve(bytes);
+    starts.reserve(records);
+    owners.reserve(records);
+    recordOf.reserve(records);
+}
+
+std::vector<int> TextArena::search(const std::string& keyword, int field) const {
+    std::vector<int> results;
+    if (keyword.empty()) {
+        for (int owner : owners) {
+            if (owner != 0) {
+                results.push_back(owner);
+            }
+        }
+        return results;
+    }
+
+    size_t from = 0;
+    while (true) {
+        size_t pos = findKernel(text.data(), text.size(), keyword.data(), keyword.size(), from);
+        if (pos == NOT_FOUND) {
+            break;
+        }
+        // 一条记录命中一次即可，直接跳到下一条记录
+        size_t record = recordAt(pos);
+        if (field >= 0) {
+            const char* start = text.data() + starts[record];
+            int at = static_cast<int>(std::count(start, text.data() + pos, FIELD_SEPARATOR));
+            if (at != field) {
+                // 不在指定字段内：指定字段在后面时从下一个位置继续，否则这条记录不会再命中
+                from = at < field ? pos + 1 : recordEnd(record);
+                continue;
+            }
+        }
+        if (owners[record] != 0) {
+            results.push_back(owners[record]);
+        }
+        from = recordEnd(record);
+    }
+    return results;
+}
+
+size_t TextArena::size() const {
+    return recordOf.size();
+}
+
+size_t TextArena::bytes() const {
+    return text.size();
+}
@@ -0,0 +1,45 @@
+#ifndef TEXT_ARENA_H
+#define TEXT_ARENA_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 检索文本区：所有记录的可检索字段经foldText规范化后连续存放在一块缓冲区中，
+// 字段之间以'\x1f'分隔，记录之间以'\n'分隔，另存每条记录的起始偏移和所属ID。
+// 子串检索直接扫描整块缓冲区：先用SIMD同时比较关键字的首字节和末字节筛出候选位置，
+// 再逐个校验中间部分，命中后按偏移二分找到所属记录，并跳到下一条记录继续扫描。
+// 删除的记录只标记为空，空洞超过一半时整体压缩。
+class TextArena {
+private:
+    std::string text;
+    std::vector<size_t> starts;                 // 每条记录的起始偏移
+    std::vector<int> owners;                    // 每条记录所属的ID，已删除的为0
+    std::unordered_map<int, size_t> recordOf;   // ID -> 记录下标
+    size_t deadBytes;                           // 已删除记录占用的字节数
+    std::string buffer;                         // 规范化时复用的缓冲区
+
+    size_t recordAt(size_t offset) const;
+    size_t recordEnd(size_t record) const;
+    void compactIfNeeded();
+
+public:
+    TextArena();
+
+    // 追加一条记录；ID已存在时先删除旧记录
+    void add(int ownerId, std::initializer_list<const std::string*> fields);
+    void remove(int ownerId);
+    void clear();
+    void reserve(size_t bytes, size_t records);
+
+    // 包含关键字（需已经foldText规范化）的记录ID，按加入顺序；关键字为空时返回全部记录。
+    // field不小于0时只算落在第field个字段（按add时的顺序，从0开始）内的命中
+    std::vector<int> search(const std::string& keyword, int field = -1) const;
+
+    size_t size() const;
+    size_t bytes() const;
+};
+
+#endif // TEXT_ARENA_H
@@ -0,0 +1,159 @@
+#include "TextFold.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TEXT_FOLD_SSE2 1
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define TEXT_FOLD_AVX2 1
+#endif
+
+namespace {
+
+// 折叠从p开始的一个字符，写出一个字节到dst，返回消耗的输入字节数
+inline size_t foldOne(const unsigned char* p, const unsigned char* end, char* dst) {
+    unsigned char c = p[0];
+    if (c < 0x80) {
+        *dst = static_cast<char>(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+        return 1;
+    }
+
+    // 全角ASCII：U+FF01～U+FF5E，UTF-8为EF BC 81～EF BD 9E
+    if (c == 0xEF && end - p >= 3 && (p[1] == 0xBC || p[1] == 0xBD) && (p[2] & 0xC0) == 0x80) {
+        unsigned codePoint = 0xF000 | ((p[1] & 0x3Fu) << 6) | (p[2] & 0x3Fu);
+        if (codePoint >= 0xFF01 && codePoint <= 0xFF5E) {
+            unsigned char ascii = static_cast<unsigned char>(codePoint - 0xFEE0);
+            *dst = static_cast<char>(ascii >= 'A' && ascii <= 'Z' ? ascii + ('a' - 'A') : ascii);
+            return 3;
+        }
+    }
+
+    // 全角空格：U+3000，UTF-8为E3 80 80
+    if (c == 0xE3 && end - p >= 3 && p[1] == 0x80 && p[2] == 0x80) {
+        *dst = ' ';
+        return 3;
+    }
+
+    // 其他多字节字符逐字节原样复制（后续字节不会被误认为需要折叠的首字节）
+    *dst = static_cast<char>(c);
+    return 1;
+}
+
+// 逐字符处理到stop为止（最后一个字符可能越过stop），返回新的输入位置
+inline const unsigned char* foldUntil(const unsigned char* p, const unsigned char* stop,
+                                      const unsigned char* end, char*& dst) {
+    while (p < stop) {
+        p += foldOne(p, end, dst++);
+    }
+    return p;
+}
+
+size_t foldScalar(const unsigned char* p, size_t size, char* out) {
+    char* dst = out;
+    foldUntil(p, p + size, p + size, dst);
+    return dst - out;
+}
+
+#ifdef TEXT_FOLD_SSE2
+// 块内没有EF、E3首字节时不可能有全角字符，只需把A～Z加上0x20，输出与输入等长
+size_t foldSse2(const unsigned char* p, size_t size, char* out) {
+    const unsigned char* end = p + size;
+    char* dst = out;
+    const __m128i upperA = _mm_set1_epi8('A');
+    const __m128i range = _mm_set1_epi8(25);
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i leadEF = _mm_set1_epi8(static_cast<char>(0xEF));
+    const __m128i leadE3 = _mm_set1_epi8(static_cast<char>(0xE3));
+
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i special = _mm_or_si128(_mm_cmpeq_epi8(v, leadEF), _mm_cmpeq_epi8(v, leadE3));
+        if (_mm_movemask_epi8(special) != 0) {
+            p = foldUntil(p, p + 16, end, dst);
+            continue;
+        }
+        // c - 'A'按无符号比较不超过25即为大写字母
+        __m128i offset = _mm_sub_epi8(v, upperA);
+        __m128i isUpper = _mm_cmpeq_epi8(_mm_min_epu8(offset, range), offset);
+        v = _mm_or_si128(v, _mm_and_si128(isUpper, caseBit));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+        p += 16;
+        dst += 16;
+    }
+    foldUntil(p, end, end, dst);
+    return dst - out;
+}
+#endif
+
+#ifdef TEXT_FOLD_AVX2
+__attribute__((target("avx2")))
+size_t foldAvx2(const unsigned char* p, size_t size, char* out) {
+    const unsigned char* end = p + size;
+    char* dst = out;
+    const __m256i upperA = _mm256_set1_epi8('A');
+    const __m256i range = _mm256_set1_epi8(25);
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    const __m256i leadEF = _mm256_set1_epi8(static_cast<char>(0xEF));
+    const __m256i leadE3 = _mm256_set1_epi8(static_cast<char>(0xE3));
+
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i special = _mm256_or_si256(_mm256_cmpeq_epi8(v, leadEF), _mm256_cmpeq_epi8(v, leadE3));
+        if (_mm256_movemask_epi8(special) != 0) {
+            p = foldUntil(p, p + 32, end, dst);
+            continue;
+        }
+        __m256i offset = _mm256_sub_epi8(v, upperA);
+        __m256i isUpper = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, range), offset);
+        v = _mm256_or_si256(v, _mm256_and_si256(isUpper, caseBit));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), v);
+        p += 32;
+        dst += 32;
+    }
+    foldUntil(p, end, end, dst);
+    return dst - out;
+}
+#endif
+
+typedef size_t (*FoldKernel)(const unsigned char*, size_t, char*);
+
+FoldKernel selectKernel() {
+#ifdef TEXT_FOLD_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return foldAvx2;
+    }
+#endif
+#ifdef TEXT_FOLD_SSE2
+    return foldSse2;
+#else
+    return foldScalar;
+#endif
+}
+
+const FoldKernel foldKernel = selectKernel();
+
+} // namespace
+
+void foldText(const char* data, size_t size, std::string& out) {
+    out.resize(size);
+    size_t written = foldKernel(reinterpret_cast<const unsigned char*>(data), size, &out[0]);
+    out.resize(written);
+}
+
+void foldText(const std::string& text, std::string& out) {
+    foldText(text.data(), text.size(), out);
+}
+
+std::string foldText(const std::string& text) {
+    std::string out;
+    foldText(text, out);
+    return out;
+}
+
+void foldTextScalar(const char* data, size_t size, std::string& out) {
+    out.resize(size);
+    size_t written = foldScalar(reinterpret_cast<const unsigned char*>(data), size, &out[0]);
+    out.resize(written);
+}
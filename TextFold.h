@@ -0,0 +1,21 @@
+#ifndef TEXT_FOLD_H
+#define TEXT_FOLD_H
+
+#include <cstddef>
+#include <string>
+
+// 检索用的大小写折叠与规范化（UTF-8）：
+//   ASCII大写字母转小写；
+//   全角ASCII字符（U+FF01～U+FF5E，如“ＡＢＣ１２３”）转为对应的半角字符，字母再转小写；
+//   全角空格（U+3000）转为半角空格；
+//   其余字符原样保留。
+// 结果只会变短不会变长。x86-64上纯ASCII和不含全角字符的数据块用SSE2/AVX2按16/32字节处理，
+// 运行时检测是否支持AVX2；其他平台使用逐字节的实现。
+void foldText(const char* data, size_t size, std::string& out);
+void foldText(const std::string& text, std::string& out);
+std::string foldText(const std::string& text);
+
+// 逐字节的参考实现，tests/KernelCheck.cpp 用它校验向量化实现
+void foldTextScalar(const char* data, size_t size, std::string& out);
+
+#endif // TEXT_FOLD_H
@@ -0,0 +1,90 @@
+#include "Title.h"
+#include <iostream>
+#include <algorithm>
+
+Title::Title() : id(0), totalCopies(0), availableCopies(0) {}
+
+Title::Title(int id, const std::string& name, const std::string& author, const std::string& publisher)
+    : id(id), name(name), author(author), publisher(publisher), totalCopies(0), availableCopies(0) {}
+
+int Title::getId() const {
+    return id;
+}
+
+const std::string& Title::getName() const {
+    return name;
+}
+
+const std::string& Title::getAuthor() const {
+    return author;
+}
+
+const std::string& Title::getPublisher() const {
+    return publisher;
+}
+
+int Title::getTotalCopies() const {
+    return totalCopies;
+}
+
+int Title::getAvailableCopies() const {
+    return availableCopies;
+}
+
+bool Title::hasAvailableCopy() const {
+    return availableCopies > 0;
+}
+
+const std::vector<int>& Title::getCopyIds() const {
+    return copyIds;
+}
+
+void Title::setId(int id) {
+    this->id = id;
+}
+
+void Title::addCopy(int bookId, bool borrowed) {
+    copyIds.push_back(bookId);
+    ++totalCopies;
+    if (!borrowed) {
+        ++availableCopies;
+    }
+}
+
+void Title::removeCopy(int bookId, bool borrowed) {
+    auto it = std::find(copyIds.begin(), copyIds.end(), bookId);
+    if (it == copyIds.end()) {
+        return;
+    }
+    copyIds.erase(it);
+    --totalCopies;
+    if (!borrowed) {
+        --availableCopies;
+    }
+}
+
+void Title::copyBorrowed() {
+    --availableCopies;
+}
+
+void Title::copyReturned() {
+    ++availableCopies;
+}
+
+void Title::display() const {
+    std::cout << "书名: " << name << std::endl;
+    std::cout << "作者: " << author << std::endl;
+    std::cout << "出版社: " << publisher << std::endl;
+    std::cout << "馆藏: " << totalCopies << " 册，可借: " << availableCopies << " 册" << std::endl;
+
+    if (!copyIds.empty()) {
+        std::cout << "图书ID: ";
+        for (size_t i = 0; i < copyIds.size(); ++i) {
+            std::cout << copyIds[i];
+            if (i < copyIds.size() - 1) {
+                std::cout << ", ";
+            }
+        }
+        std::cout << std::endl;
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef TITLE_H
+#define TITLE_H
+
+#include <string>
+#include <vector>
+
+// 书目：同一书名、作者、出版社的图书共用一条书目记录，
+// 每一册实体书（副本）只保存自己的ID和借阅状态
+class Title {
+private:
+    int id;                  // 书目ID（加载时分配，不写入文件）
+    std::string name;        // 图书名称
+    std::string author;      // 作者
+    std::string publisher;   // 出版社
+    int totalCopies;         // 馆藏册数
+    int availableCopies;     // 可借册数
+    std::vector<int> copyIds;  // 各副本的图书ID
+
+public:
+    Title();
+    Title(int id, const std::string& name, const std::string& author, const std::string& publisher);
+
+    // 获取书目信息
+    int getId() const;
+    const std::string& getName() const;
+    const std::string& getAuthor() const;
+    const std::string& getPublisher() const;
+    int getTotalCopies() const;
+    int getAvailableCopies() const;
+    bool hasAvailableCopy() const;
+    const std::vector<int>& getCopyIds() const;
+
+    // 设置书目信息；书名、作者、出版社是书目在各索引中的键，建立后不再修改
+    void setId(int id);
+
+    // 副本增减与借还计数
+    void addCopy(int bookId, bool borrowed);
+    void removeCopy(int bookId, bool borrowed);
+    void copyBorrowed();
+    void copyReturned();
+
+    // 显示书目信息
+    void display() const;
+
+    friend class RecordParser;
+};
+
+#endif // TITLE_H
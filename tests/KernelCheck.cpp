@@ -0,0 +1,99 @@
+// 向量化内核与逐字节/逐个归并的参考实现对拍：随机生成输入，结果必须完全一致。
+// 用 ctest 运行；编译时加 -fsanitize=address,undefined 可同时检查越界读写
+#include "../TextFold.h"
+#include "../PostingLists.h"
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 以ASCII为主，混入大写字母、全角字符、全角空格、其他汉字和任意字节（含被截断的多字节序列）
+std::string randomText(std::mt19937& rng) {
+    static const char* const pieces[] = {
+        "\xEF\xBC\xA1", "\xEF\xBD\x9A", "\xEF\xBC\x91", "\xEF\xBD\x9E", "\xEF\xBC\x81",  // 全角Ａ ｚ １ ～ ！
+        "\xE3\x80\x80", "\xE4\xB8\xAD", "\xEF\xBF\xBD", "\xEF\xBC", "\xE3\x80",           // 全角空格、中、截断序列
+    };
+    std::uniform_int_distribution<int> length(0, 200);
+    std::uniform_int_distribution<int> kind(0, 99);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> piece(0, sizeof(pieces) / sizeof(pieces[0]) - 1);
+    int special = kind(rng) % 3 == 0 ? 0 : kind(rng) % 20;   // 三分之一的样本是纯ASCII
+
+    std::string text;
+    for (int i = length(rng); i > 0; --i) {
+        int k = kind(rng);
+        if (k < special) {
+            text += pieces[piece(rng)];
+        } else if (k < special + 2) {
+            text += static_cast<char>(byte(rng));
+        } else if (k < 40) {
+            text += static_cast<char>('A' + k % 26);
+        } else {
+            text += static_cast<char>(' ' + k % 95);
+        }
+    }
+    return text;
+}
+
+// 从[1, range]中按density取值，升序无重复
+std::vector<int> randomPostings(std::mt19937& rng, int range, double density) {
+    std::bernoulli_distribution pick(density);
+    std::vector<int> list;
+    for (int id = 1; id <= range; ++id) {
+        if (pick(rng)) {
+            list.push_back(id);
+        }
+    }
+    return list;
+}
+
+bool checkFold(std::mt19937& rng, int rounds) {
+    std::string fast, slow;
+    for (int round = 0; round < rounds; ++round) {
+        std::string text = randomText(rng);
+        // 从不同偏移开始，覆盖未对齐的加载和各种尾部长度
+        for (size_t offset = 0; offset < 4 && offset <= text.size(); ++offset) {
+            foldText(text.data() + offset, text.size() - offset, fast);
+            foldTextScalar(text.data() + offset, text.size() - offset, slow);
+            if (fast != slow) {
+                std::cout << "foldText 与参考实现不一致：长度 " << text.size() << "，偏移 " << offset << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool checkIntersect(std::mt19937& rng, int rounds) {
+    std::uniform_int_distribution<int> range(0, 2000);
+    std::uniform_real_distribution<double> density(0.0, 1.0);
+    std::vector<int> fast, slow;
+    for (int round = 0; round < rounds; ++round) {
+        int n = range(rng);
+        // 一半样本让两表疏密悬殊，走跳跃查找；其余长度相近，走SSE2逐块比较
+        double da = density(rng);
+        double db = round % 2 == 0 ? da * density(rng) * density(rng) * 0.1 : density(rng);
+        std::vector<int> a = randomPostings(rng, n, da);
+        std::vector<int> b = randomPostings(rng, n, db);
+        intersectPostings(a, b, fast);
+        intersectPostingsScalar(a, b, slow);
+        if (fast != slow) {
+            std::cout << "intersectPostings 与参考实现不一致：表长 " << a.size() << "、" << b.size() << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::uint32_t seed = argc > 1 ? static_cast<std::uint32_t>(std::stoul(argv[1])) : 20240601u;
+    std::mt19937 rng(seed);
+    bool ok = checkFold(rng, 20000) && checkIntersect(rng, 5000);
+    std::cout << (ok ? "全部一致" : "校验失败") << "（随机种子 " << seed << "）" << std::endl;
+    return ok ? 0 : 1;
+}